@@ -0,0 +1,37 @@
+//
+//  benchmark_util.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+//  Helpers shared by the benchmarks (map_benchmark.cpp, timer_benchmark.c).
+//
+
+#ifndef YYMidiBase_benchmark_util_h
+#define YYMidiBase_benchmark_util_h
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+/// Bytes allocated with malloc (and operator new) now, 0 if the platform cannot tell.
+static inline long heap_bytes(void) {
+#if defined(__APPLE__)
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return (long)stats.size_in_use;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (long)(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return (long)(unsigned)info.uordblks + (long)(unsigned)info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+#endif
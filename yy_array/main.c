@@ -5,9 +5,13 @@
 //
 
 #include <CoreFoundation/CoreFoundation.h>
+#include <assert.h>
+#include <math.h>
+#include <unistd.h>
 
 #include "yy_array.h"
 #include "yy_map.h"
+#include "yy_string_array.h"
 
 
 static inline void profile_time(void (^block)(void), void (^complete)(double ms)) {
@@ -114,8 +118,278 @@ void test_array() {
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+///                              Test Parallel                               ///
+////////////////////////////////////////////////////////////////////////////////
+
+static void parallel_work(long index, const void *value, void *context) {
+    double *results = context;
+    double x = (long)value;
+    for (int i = 0; i < 64; i++) x = sin(x) + cos(x);
+    results[index] = x;
+}
+
+static void *parallel_map(long index, const void *value, void *context) {
+    double x = (long)value;
+    (void)index;
+    (void)context;
+    for (int i = 0; i < 64; i++) x = sin(x) + cos(x);
+    return (void *)(long)(x * 1000);
+}
+
+static void *parallel_combine(void *result1, void *result2, void *context) {
+    (void)context;
+    return (void *)((long)result1 + (long)result2);
+}
+
+void test_parallel() {
+    int count = 1000000;
+    yy_array_t *yy_array = yy_array_create_with_options(count, NULL);
+    double *results = malloc(count * sizeof(double));
+    long cpu = sysconf(_SC_NPROCESSORS_ONLN);
+    __block double serial_ms = 0;
+    
+    for (int i = 0; i < count; i++) {
+        yy_array_append(yy_array, (void *)(long)i);
+    }
+    
+    printf("--------------------------------\n");
+    printf("  parallel foreach (%ld cpu)\n", cpu);
+    printf("--------------------------------\n");
+    printf("grain\t|time\t\t|speedup\t|efficiency\n");
+    
+    profile_time(^ {
+        yy_array_foreach(yy_array, parallel_work, results);
+    }, ^ (double ms) {
+        serial_ms = ms;
+        printf("serial\t|%.2fms\t|1.00\t\t|1.00\n", ms);
+    });
+    for (long grain = 256; grain <= 65536; grain *= 16) {
+        printf("%ld\t|", grain);
+        profile_time(^ {
+            yy_array_foreach_parallel(yy_array, yy_range_make(0, count), parallel_work, results, grain);
+        }, ^ (double ms) {
+            printf("%.2fms\t|%.2f\t\t|%.2f\n", ms, serial_ms / ms, serial_ms / ms / cpu);
+        });
+    }
+    
+    printf("\n\n");
+    printf("--------------------------------\n");
+    printf("  parallel reduce (%ld cpu)\n", cpu);
+    printf("--------------------------------\n");
+    printf("grain\t|time\t\t|speedup\t|efficiency\n");
+    
+    profile_time(^ {
+        yy_array_reduce_parallel(yy_array, yy_range_make(0, count), parallel_map, parallel_combine, NULL, NULL, count);
+    }, ^ (double ms) {
+        serial_ms = ms;
+        printf("serial\t|%.2fms\t|1.00\t\t|1.00\n", ms);
+    });
+    for (long grain = 256; grain <= 65536; grain *= 16) {
+        printf("%ld\t|", grain);
+        profile_time(^ {
+            yy_array_reduce_parallel(yy_array, yy_range_make(0, count), parallel_map, parallel_combine, NULL, NULL, grain);
+        }, ^ (double ms) {
+            printf("%.2fms\t|%.2f\t\t|%.2f\n", ms, serial_ms / ms, serial_ms / ms / cpu);
+        });
+    }
+    
+    yy_release(yy_array);
+    free(results);
+    
+    printf("\n");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                            Test String Array                             ///
+////////////////////////////////////////////////////////////////////////////////
+
+void test_string_array() {
+    yy_array_t *yy_array = yy_array_create_for_string();
+    yy_string_array_t *string_array = yy_string_array_create();
+    int count = 1000000;
+    
+    printf("--------------------------------\n");
+    printf("    %d short strings\n", count);
+    printf("--------------------------------\n");
+    printf("op\t|yy_array\t|yy_string_array\n");
+    
+    printf("append\t|");
+    profile_time(^ {
+        char buf[32];
+        for (int i = 0; i < count; i++) {
+            snprintf(buf, sizeof(buf), "note_%d", i);
+            yy_array_append(yy_array, buf);
+        }
+    }, ^ (double ms) {
+        printf("%.2fms\t|", ms);
+    });
+    profile_time(^ {
+        char buf[32];
+        for (int i = 0; i < count; i++) {
+            snprintf(buf, sizeof(buf), "note_%d", i);
+            yy_string_array_append(string_array, buf);
+        }
+    }, ^ (double ms) {
+        printf("%.2fms\n", ms);
+    });
+    
+    printf("index\t|");
+    profile_time(^ {
+        for (int i = 0; i < 10; i++) {
+            yy_array_get_first_index(yy_array, yy_range_make(0, count), "note_999999");
+        }
+    }, ^ (double ms) {
+        printf("%.2fms\t|", ms);
+    });
+    profile_time(^ {
+        for (int i = 0; i < 10; i++) {
+            yy_string_array_get_first_index(string_array, "note_999999");
+        }
+    }, ^ (double ms) {
+        printf("%.2fms\n", ms);
+    });
+    
+    printf("memory\t|%.2fMB*\t|%.2fMB\n",
+           count * (sizeof(void *) + 16.0 + 16.0) / 1048576.0,
+           yy_string_array_get_memory_size(string_array) / 1048576.0);
+    printf("(* ring + one malloc block of ~16 bytes per string)\n");
+    
+    yy_release(yy_array);
+    yy_release(string_array);
+    
+    printf("\n");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                             Test Map Transfer                            ///
+////////////////////////////////////////////////////////////////////////////////
+
+static void check_retain_count(const char *name, void *object, long expected) {
+    long count = yy_retain_count(object);
+    printf("%s\t|%ld\t|%s\n", name, count, count == expected ? "ok" : "FAILED");
+    assert(count == expected);
+}
+
+void test_map_transfer() {
+    yy_map_t *map = yy_map_create_with_options(0, &yy_map_object_key_callback, &yy_map_object_value_callback);
+    yy_array_t *key = yy_array_create();
+    yy_array_t *value = yy_array_create();
+    yy_array_t *other = yy_array_create();
+    
+    printf("--------------------------------\n");
+    printf("   set_transfer retain counts\n");
+    printf("--------------------------------\n");
+    printf("object\t|count\t|result\n");
+    
+    yy_map_set(map, key, value);
+    check_retain_count("key", key, 2);
+    check_retain_count("value", value, 2);
+    
+    /* the same key and value again: both adopted references are released */
+    yy_retain(key);
+    yy_retain(value);
+    yy_map_set_transfer(map, key, value);
+    check_retain_count("key", key, 2);
+    check_retain_count("value", value, 2);
+    
+    /* the same key with a new value: the key reference and the old value are released */
+    yy_retain(key);
+    yy_map_set_transfer(map, key, other);
+    check_retain_count("key", key, 2);
+    check_retain_count("value", value, 1);
+    check_retain_count("other", other, 1);
+    
+    /* other is owned by the map and released with the entry */
+    yy_map_remove(map, key);
+    check_retain_count("key", key, 1);
+    
+    yy_release(map);
+    yy_release(key);
+    yy_release(value);
+    
+    printf("\n");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                               Test Map Scan                              ///
+////////////////////////////////////////////////////////////////////////////////
+
+/* few distinct hashes, so the buckets hold long chains */
+static unsigned long scan_collide_hash(const void *key) {
+    return (unsigned long)key % 7;
+}
+
+static bool scan_pointer_equal(const void *key1, const void *key2) {
+    return key1 == key2;
+}
+
+/* scan with a batch of 1 (grown when a bucket needs more), removing every key once returned */
+static bool scan_and_remove(yy_map_t *map, long key_count) {
+    unsigned long cursor = 0;
+    long capacity = 1, n, i, returned = 0;
+    const void **keys = malloc(capacity * sizeof(void *));
+    bool *seen = calloc(key_count + 1, sizeof(bool));
+    bool ok = true;
+    
+    do {
+        n = yy_map_scan(map, &cursor, capacity, keys, NULL);
+        if (n < -1) {
+            capacity = -n;
+            keys = realloc(keys, capacity * sizeof(void *));
+            n = yy_map_scan(map, &cursor, capacity, keys, NULL);
+        }
+        for (i = 0; i < n; i++) {
+            if (!seen[(long)keys[i]]) returned++;
+            seen[(long)keys[i]] = true;
+            yy_map_remove(map, keys[i]);
+        }
+    } while (n >= 0 && cursor != 0);
+    
+    for (i = 1; i <= key_count; i++) {
+        if (!seen[i]) ok = false;
+    }
+    printf("%ld\t|%ld\t|%ld\t|%s\n", key_count, returned, capacity, ok ? "ok" : "FAILED");
+    free(keys);
+    free(seen);
+    return ok;
+}
+
+void test_map_scan() {
+    yy_map_key_callback_t collide_callback = {NULL, NULL, scan_pointer_equal, scan_collide_hash};
+    yy_map_t *map;
+    long i;
+    
+    printf("--------------------------------\n");
+    printf("   scan, removing returned keys\n");
+    printf("--------------------------------\n");
+    printf("keys\t|seen\t|batch\t|result\n");
+    
+    map = yy_map_create();
+    for (i = 1; i <= 1000; i++) yy_map_set(map, (const void *)i, (const void *)i);
+    assert(scan_and_remove(map, 1000));
+    assert(yy_map_count(map) == 0);
+    yy_release(map);
+    
+    map = yy_map_create_with_options(0, &collide_callback, NULL);
+    for (i = 1; i <= 300; i++) yy_map_set(map, (const void *)i, (const void *)i);
+    assert(scan_and_remove(map, 300));
+    assert(yy_map_count(map) == 0);
+    yy_release(map);
+    
+    printf("\n");
+}
+
+
 int main(int argc, const char * argv[]) {
     test_array();
+    test_parallel();
+    test_string_array();
+    test_map_transfer();
+    test_map_scan();
     CFShow(CFSTR("Done!\n"));
     return 0;
 }
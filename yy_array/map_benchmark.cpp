@@ -0,0 +1,614 @@
+//
+//  map_benchmark.cpp
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+//  Benchmark of yy_map against std::unordered_map and a flat open addressing
+//  table: set, get (hit and miss), remove and foreach, with integer, pointer
+//  and string keys, uniform, zipfian and sequential access, several sizes and
+//  load factors. Results are written as CSV (default) or JSON.
+//
+//  usage: map_benchmark [--sizes 1000,100000] [--keys int,pointer,string]
+//                       [--dists uniform,zipf,sequential] [--load-factors 0.5,0.75,0.9]
+//                       [--maps yy_map,std,flat] [--ops N] [--seed N] [--format csv|json]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "yy_map.h"
+}
+#include "benchmark_util.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Utility                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+typedef std::chrono::steady_clock bench_clock;
+
+static inline double seconds_since(bench_clock::time_point t0) {
+    return std::chrono::duration<double>(bench_clock::now() - t0).count();
+}
+
+static inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+struct random_generator {
+    uint64_t state;
+    explicit random_generator(uint64_t seed) : state(seed) {}
+    uint64_t next() { state += 0x9E3779B97F4A7C15ULL; return splitmix64(state); }
+    double next_double() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    uint64_t next_below(uint64_t n) { return next() % n; }
+};
+
+/// Zipfian ranks in [0, n) with the method of Gray et al. (as in YCSB), O(1) memory.
+struct zipf_generator {
+    double theta, zetan, alpha, eta;
+    uint64_t n;
+
+    zipf_generator(uint64_t n, double theta) : theta(theta), n(n) {
+        double zeta2 = 1.0 + pow(0.5, theta);
+        zetan = 0;
+        for (uint64_t i = 1; i <= n; i++) zetan += 1.0 / pow((double)i, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+    uint64_t next(random_generator &random) {
+        double u = random.next_double();
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + pow(0.5, theta)) return 1;
+        uint64_t rank = (uint64_t)(n * pow(eta * u - eta + 1.0, alpha));
+        return rank < n ? rank : n - 1;
+    }
+};
+
+static std::vector<std::string> split(const char *list) {
+    std::vector<std::string> items;
+    std::string item;
+    for (const char *p = list; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            if (!item.empty()) items.push_back(item);
+            item.clear();
+            if (*p == '\0') break;
+        } else {
+            item += *p;
+        }
+    }
+    return items;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                               Flat Table                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint64_t hash_integer(uintptr_t key) {
+    return splitmix64(key);
+}
+
+/// FNV-1a
+static inline uint64_t hash_string(const char *key) {
+    uint64_t hash = 14695981039346656037ULL;
+    while (*key) hash = (hash ^ (unsigned char)*key++) * 1099511628211ULL;
+    return hash;
+}
+
+struct integer_traits {
+    static uint64_t hash(uintptr_t key) { return hash_integer(key); }
+    static bool equal(uintptr_t a, uintptr_t b) { return a == b; }
+};
+
+struct string_traits {
+    static uint64_t hash(uintptr_t key) { return hash_string((const char *)key); }
+    static bool equal(uintptr_t a, uintptr_t b) { return strcmp((const char *)a, (const char *)b) == 0; }
+};
+
+/**
+ Open addressing with linear probing and backward shift deletion, power of 2
+ slot count, grows when count > slot count * load factor. Keys are not copied.
+ */
+template <typename traits>
+class flat_map {
+    struct slot { uintptr_t key; uintptr_t value; };
+    std::vector<slot> slots;
+    std::vector<uint8_t> used;
+    size_t mask, count, limit;
+    double load_factor;
+
+    void rehash(size_t slot_count) {
+        std::vector<slot> old_slots;
+        std::vector<uint8_t> old_used;
+        old_slots.swap(slots);
+        old_used.swap(used);
+        slots.assign(slot_count, slot());
+        used.assign(slot_count, 0);
+        mask = slot_count - 1;
+        limit = (size_t)(slot_count * load_factor);
+        for (size_t i = 0; i < old_slots.size(); i++) {
+            if (!old_used[i]) continue;
+            size_t j = traits::hash(old_slots[i].key) & mask;
+            while (used[j]) j = (j + 1) & mask;
+            slots[j] = old_slots[i];
+            used[j] = 1;
+        }
+    }
+
+public:
+    explicit flat_map(double load_factor) : mask(0), count(0), limit(0), load_factor(load_factor) {
+        rehash(16);
+    }
+    void reserve(size_t n) {
+        size_t slot_count = 16;
+        while (slot_count * load_factor < n) slot_count <<= 1;
+        if (slot_count > slots.size()) rehash(slot_count);
+    }
+    void set(uintptr_t key, uintptr_t value) {
+        if (count + 1 > limit) rehash(slots.size() * 2);
+        size_t i = traits::hash(key) & mask;
+        while (used[i]) {
+            if (traits::equal(slots[i].key, key)) {
+                slots[i].value = value;
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+        slots[i].key = key;
+        slots[i].value = value;
+        used[i] = 1;
+        count++;
+    }
+    bool get(uintptr_t key, uintptr_t *value) const {
+        size_t i = traits::hash(key) & mask;
+        while (used[i]) {
+            if (traits::equal(slots[i].key, key)) {
+                *value = slots[i].value;
+                return true;
+            }
+            i = (i + 1) & mask;
+        }
+        return false;
+    }
+    bool remove(uintptr_t key) {
+        size_t i = traits::hash(key) & mask;
+        while (used[i] && !traits::equal(slots[i].key, key)) i = (i + 1) & mask;
+        if (!used[i]) return false;
+        /* shift the following entries back over the hole */
+        size_t j = i;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (!used[j]) break;
+            size_t home = traits::hash(slots[j].key) & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        used[i] = 0;
+        count--;
+        return true;
+    }
+    template <typename func> void foreach(func f) const {
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (used[i]) f(slots[i].key, slots[i].value);
+        }
+    }
+    size_t size() const { return count; }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                               Map Adapters                               ///
+////////////////////////////////////////////////////////////////////////////////
+
+/// yy_map, string keys are copied (yy_map_string_key_callback). Its load factor is fixed, run_map() passes 0.75.
+struct yy_map_adapter {
+    yy_map_t *map;
+    static const char *name() { return "yy_map"; }
+
+    yy_map_adapter(bool string_keys, double load_factor, size_t reserve) {
+        long capacity = reserve ? (long)(reserve / load_factor) + 1 : 0;
+        map = yy_map_create_with_options(capacity, string_keys ? &yy_map_string_key_callback : NULL, NULL);
+    }
+    ~yy_map_adapter() { yy_release(map); }
+    void set(uintptr_t key, uintptr_t value) { yy_map_set(map, (const void *)key, (const void *)value); }
+    bool get(uintptr_t key, uintptr_t *value) {
+        const void *v = yy_map_get(map, (const void *)key);
+        *value = (uintptr_t)v;
+        return v != NULL;
+    }
+    bool remove(uintptr_t key) { return yy_map_remove(map, (const void *)key); }
+    static void sum_value(const void *, const void *value, void *context) {
+        *(uintptr_t *)context += (uintptr_t)value;
+    }
+    uintptr_t foreach_sum() {
+        uintptr_t sum = 0;
+        yy_map_foreach(map, sum_value, &sum);
+        return sum;
+    }
+};
+
+/// std::unordered_map, string keys are copied (std::string).
+template <bool string_keys> struct std_map_adapter;
+
+template <> struct std_map_adapter<false> {
+    std::unordered_map<uintptr_t, uintptr_t> map;
+    static const char *name() { return "std"; }
+
+    std_map_adapter(bool, double load_factor, size_t reserve) {
+        map.max_load_factor((float)load_factor);
+        if (reserve) map.reserve(reserve);
+    }
+    void set(uintptr_t key, uintptr_t value) { map[key] = value; }
+    bool get(uintptr_t key, uintptr_t *value) {
+        std::unordered_map<uintptr_t, uintptr_t>::const_iterator it = map.find(key);
+        if (it == map.end()) return false;
+        *value = it->second;
+        return true;
+    }
+    bool remove(uintptr_t key) { return map.erase(key) > 0; }
+    uintptr_t foreach_sum() {
+        uintptr_t sum = 0;
+        for (std::unordered_map<uintptr_t, uintptr_t>::const_iterator it = map.begin(); it != map.end(); ++it) sum += it->second;
+        return sum;
+    }
+};
+
+template <> struct std_map_adapter<true> {
+    std::unordered_map<std::string, uintptr_t> map;
+    static const char *name() { return "std"; }
+
+    std_map_adapter(bool, double load_factor, size_t reserve) {
+        map.max_load_factor((float)load_factor);
+        if (reserve) map.reserve(reserve);
+    }
+    void set(uintptr_t key, uintptr_t value) { map[(const char *)key] = value; }
+    bool get(uintptr_t key, uintptr_t *value) {
+        std::unordered_map<std::string, uintptr_t>::const_iterator it = map.find((const char *)key);
+        if (it == map.end()) return false;
+        *value = it->second;
+        return true;
+    }
+    bool remove(uintptr_t key) { return map.erase((const char *)key) > 0; }
+    uintptr_t foreach_sum() {
+        uintptr_t sum = 0;
+        for (std::unordered_map<std::string, uintptr_t>::const_iterator it = map.begin(); it != map.end(); ++it) sum += it->second;
+        return sum;
+    }
+};
+
+/// Flat table, string keys point to the benchmark key pool.
+template <typename traits> struct flat_map_adapter {
+    flat_map<traits> map;
+    static const char *name() { return "flat"; }
+
+    flat_map_adapter(bool, double load_factor, size_t reserve) : map(load_factor) {
+        if (reserve) map.reserve(reserve);
+    }
+    void set(uintptr_t key, uintptr_t value) { map.set(key, value); }
+    bool get(uintptr_t key, uintptr_t *value) { return map.get(key, value); }
+    bool remove(uintptr_t key) { return map.remove(key); }
+    uintptr_t foreach_sum() {
+        uintptr_t sum = 0;
+        map.foreach([&sum](uintptr_t, uintptr_t value) { sum += value; });
+        return sum;
+    }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                                Benchmark                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+struct bench_config {
+    std::vector<long> sizes;
+    std::vector<std::string> keys, dists, maps;
+    std::vector<double> load_factors;
+    long ops;
+    uint64_t seed;
+    bool json;
+};
+
+/// Keys of one run: `keys` are inserted, `misses` are never inserted.
+struct key_set {
+    std::vector<uintptr_t> keys, misses;
+    std::vector<std::string> strings;   ///< storage of string keys
+    std::vector<uint64_t> objects;      ///< storage of pointer keys
+    std::vector<long> order;            ///< insertion order (indices in keys)
+    std::vector<long> lookups;          ///< lookup stream (indices in keys and misses)
+    bool string_keys;
+};
+
+static void make_keys(key_set &set, const std::string &type, const std::string &dist, long n, long ops, uint64_t seed) {
+    random_generator random(seed);
+    char buffer[64];
+    long i;
+
+    set.string_keys = (type == "string");
+    set.keys.resize(n);
+    set.misses.resize(n);
+    if (type == "pointer") {
+        /* addresses of objects of 16 bytes (aligned, low bits are zero) */
+        set.objects.resize(4 * n);
+        for (i = 0; i < n; i++) {
+            set.keys[i] = (uintptr_t)&set.objects[2 * i];
+            set.misses[i] = (uintptr_t)&set.objects[2 * (n + i)];
+        }
+    } else {
+        /* sequential: 1, 2, 3...  others: distinct random values */
+        for (i = 0; i < n; i++) {
+            set.keys[i] = dist == "sequential" ? (uintptr_t)(i + 1) : (uintptr_t)splitmix64(seed + i);
+            set.misses[i] = dist == "sequential" ? (uintptr_t)(n + i + 1) : (uintptr_t)splitmix64(seed + n + i);
+        }
+        if (set.string_keys) {
+            set.strings.resize(2 * n);
+            for (i = 0; i < n; i++) {
+                snprintf(buffer, sizeof(buffer), "key:%llx", (unsigned long long)set.keys[i]);
+                set.strings[i] = buffer;
+                snprintf(buffer, sizeof(buffer), "key:%llx", (unsigned long long)set.misses[i]);
+                set.strings[n + i] = buffer;
+            }
+            for (i = 0; i < n; i++) {
+                set.keys[i] = (uintptr_t)set.strings[i].c_str();
+                set.misses[i] = (uintptr_t)set.strings[n + i].c_str();
+            }
+        }
+    }
+
+    set.order.resize(n);
+    for (i = 0; i < n; i++) set.order[i] = i;
+    if (dist != "sequential") {
+        for (i = n - 1; i > 0; i--) std::swap(set.order[i], set.order[random.next_below(i + 1)]);
+    }
+
+    set.lookups.resize(ops);
+    if (dist == "sequential") {
+        for (i = 0; i < ops; i++) set.lookups[i] = i % n;
+    } else if (dist == "uniform") {
+        for (i = 0; i < ops; i++) set.lookups[i] = (long)random.next_below(n);
+    } else {
+        /* the hot keys are spread over the insertion order */
+        zipf_generator zipf(n, 0.99);
+        for (i = 0; i < ops; i++) set.lookups[i] = set.order[zipf.next(random)];
+    }
+}
+
+struct bench_result {
+    double insert_mops, insert_presized_mops, get_hit_mops, get_miss_mops, remove_mops, foreach_mops;
+    double bytes_per_entry;
+    double p50_ns, p99_ns, p999_ns, max_ns;
+};
+
+static double percentile(std::vector<uint32_t> &values, double p) {
+    size_t k = (size_t)(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+template <typename adapter>
+static bench_result run(const key_set &set, double load_factor) {
+    bench_result result;
+    size_t n = set.keys.size(), ops = set.lookups.size(), i;
+    uintptr_t value, sum = 0;
+    long found;
+    bench_clock::time_point t0, t1;
+    std::vector<uint32_t> latencies(n);
+
+    /* insert from an empty map, each insert timed */
+    {
+        long heap0 = heap_bytes();
+        adapter map(set.string_keys, load_factor, 0);
+        for (i = 0; i < n; i++) {
+            t0 = bench_clock::now();
+            map.set(set.keys[set.order[i]], set.order[i] + 1);
+            t1 = bench_clock::now();
+            latencies[i] = (uint32_t)std::min<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count(), UINT32_MAX);
+        }
+        result.bytes_per_entry = (double)(heap_bytes() - heap0) / n;
+    }
+    result.p50_ns = percentile(latencies, 0.5);
+    result.p99_ns = percentile(latencies, 0.99);
+    result.p999_ns = percentile(latencies, 0.999);
+    result.max_ns = *std::max_element(latencies.begin(), latencies.end());
+
+    /* the same without timers, then with the final size reserved */
+    adapter map(set.string_keys, load_factor, 0);
+    t0 = bench_clock::now();
+    for (i = 0; i < n; i++) map.set(set.keys[set.order[i]], set.order[i] + 1);
+    result.insert_mops = n / seconds_since(t0) / 1e6;
+    {
+        adapter presized(set.string_keys, load_factor, n);
+        t0 = bench_clock::now();
+        for (i = 0; i < n; i++) presized.set(set.keys[set.order[i]], set.order[i] + 1);
+        result.insert_presized_mops = n / seconds_since(t0) / 1e6;
+    }
+
+    found = 0;
+    t0 = bench_clock::now();
+    for (i = 0; i < ops; i++) found += map.get(set.keys[set.lookups[i]], &value);
+    result.get_hit_mops = ops / seconds_since(t0) / 1e6;
+    if (found != (long)ops) fprintf(stderr, "%s: %ld of %ld keys found\n", adapter::name(), found, (long)ops);
+
+    found = 0;
+    t0 = bench_clock::now();
+    for (i = 0; i < ops; i++) found += map.get(set.misses[set.lookups[i]], &value);
+    result.get_miss_mops = ops / seconds_since(t0) / 1e6;
+    if (found != 0) fprintf(stderr, "%s: %ld missing keys found\n", adapter::name(), found);
+
+    t0 = bench_clock::now();
+    sum = map.foreach_sum();
+    result.foreach_mops = n / seconds_since(t0) / 1e6;
+    if (sum != (uintptr_t)n * (n + 1) / 2) fprintf(stderr, "%s: foreach sum mismatch\n", adapter::name());
+
+    t0 = bench_clock::now();
+    for (i = 0; i < n; i++) map.remove(set.keys[set.order[i]]);
+    result.remove_mops = n / seconds_since(t0) / 1e6;
+    return result;
+}
+
+static bool run_map(const std::string &map_name, const key_set &set, double load_factor, bench_result *result) {
+    if (map_name == "yy_map") {
+        *result = run<yy_map_adapter>(set, load_factor);
+    } else if (map_name == "std") {
+        *result = set.string_keys ? run<std_map_adapter<true> >(set, load_factor)
+                                  : run<std_map_adapter<false> >(set, load_factor);
+    } else if (map_name == "flat") {
+        *result = set.string_keys ? run<flat_map_adapter<string_traits> >(set, load_factor)
+                                  : run<flat_map_adapter<integer_traits> >(set, load_factor);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void print_header(const bench_config &config) {
+    if (config.json) {
+        printf("[\n");
+    } else {
+        printf("map,key,dist,size,load_factor,insert_mops,insert_presized_mops,get_hit_mops,get_miss_mops,"
+               "remove_mops,foreach_mops,bytes_per_entry,insert_p50_ns,insert_p99_ns,insert_p999_ns,insert_max_ns\n");
+    }
+}
+
+static void print_result(const bench_config &config, const std::string &map, const std::string &key,
+                         const std::string &dist, long size, double load_factor, const bench_result &r, bool first) {
+    if (config.json) {
+        printf("%s  {\"map\": \"%s\", \"key\": \"%s\", \"dist\": \"%s\", \"size\": %ld, \"load_factor\": %.2f, "
+               "\"insert_mops\": %.3f, \"insert_presized_mops\": %.3f, \"get_hit_mops\": %.3f, \"get_miss_mops\": %.3f, "
+               "\"remove_mops\": %.3f, \"foreach_mops\": %.3f, \"bytes_per_entry\": %.1f, "
+               "\"insert_p50_ns\": %.0f, \"insert_p99_ns\": %.0f, \"insert_p999_ns\": %.0f, \"insert_max_ns\": %.0f}",
+               first ? "" : ",\n", map.c_str(), key.c_str(), dist.c_str(), size, load_factor,
+               r.insert_mops, r.insert_presized_mops, r.get_hit_mops, r.get_miss_mops, r.remove_mops, r.foreach_mops,
+               r.bytes_per_entry, r.p50_ns, r.p99_ns, r.p999_ns, r.max_ns);
+    } else {
+        printf("%s,%s,%s,%ld,%.2f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.0f,%.0f,%.0f,%.0f\n",
+               map.c_str(), key.c_str(), dist.c_str(), size, load_factor,
+               r.insert_mops, r.insert_presized_mops, r.get_hit_mops, r.get_miss_mops, r.remove_mops, r.foreach_mops,
+               r.bytes_per_entry, r.p50_ns, r.p99_ns, r.p999_ns, r.max_ns);
+    }
+    fflush(stdout);
+}
+
+static void usage() {
+    fprintf(stderr, "usage: map_benchmark [--sizes 1000,100000] [--keys int,pointer,string]\n"
+                    "                     [--dists uniform,zipf,sequential] [--load-factors 0.5,0.75,0.9]\n"
+                    "                     [--maps yy_map,std,flat] [--ops N] [--seed N] [--format csv|json]\n"
+                    "sizes go from 1000 to 100000000, ops defaults to max(size, 1000000) lookups.\n");
+}
+
+static bool parse_args(int argc, const char *argv[], bench_config &config) {
+    std::vector<std::string> items;
+
+    config.sizes.clear();
+    config.sizes.push_back(1000);
+    config.sizes.push_back(10000);
+    config.sizes.push_back(100000);
+    config.sizes.push_back(1000000);
+    config.keys = split("int,pointer,string");
+    config.dists = split("uniform,zipf,sequential");
+    config.maps = split("yy_map,std,flat");
+    config.load_factors.clear();
+    config.load_factors.push_back(0.5);
+    config.load_factors.push_back(0.75);
+    config.load_factors.push_back(0.9);
+    config.ops = 0;
+    config.seed = 20140528;
+    config.json = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) return false;
+        const char *arg = argv[i], *value = argv[++i];
+        if (strcmp(arg, "--sizes") == 0) {
+            items = split(value);
+            config.sizes.clear();
+            for (size_t j = 0; j < items.size(); j++) {
+                long size = atol(items[j].c_str());
+                if (size < 1000 || size > 100000000) return false;
+                config.sizes.push_back(size);
+            }
+        } else if (strcmp(arg, "--keys") == 0) {
+            config.keys = split(value);
+            for (size_t j = 0; j < config.keys.size(); j++) {
+                if (config.keys[j] != "int" && config.keys[j] != "pointer" && config.keys[j] != "string") return false;
+            }
+        } else if (strcmp(arg, "--dists") == 0) {
+            config.dists = split(value);
+            for (size_t j = 0; j < config.dists.size(); j++) {
+                if (config.dists[j] != "uniform" && config.dists[j] != "zipf" && config.dists[j] != "sequential") return false;
+            }
+        } else if (strcmp(arg, "--maps") == 0) {
+            config.maps = split(value);
+        } else if (strcmp(arg, "--load-factors") == 0) {
+            items = split(value);
+            config.load_factors.clear();
+            for (size_t j = 0; j < items.size(); j++) {
+                double load_factor = atof(items[j].c_str());
+                if (load_factor <= 0 || load_factor >= 1) return false;
+                config.load_factors.push_back(load_factor);
+            }
+        } else if (strcmp(arg, "--ops") == 0) {
+            config.ops = atol(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            config.seed = strtoull(value, NULL, 10);
+        } else if (strcmp(arg, "--format") == 0) {
+            config.json = strcmp(value, "json") == 0;
+            if (!config.json && strcmp(value, "csv") != 0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, const char *argv[]) {
+    bench_config config;
+    bench_result result;
+    bool first = true;
+
+    if (!parse_args(argc, argv, config)) {
+        usage();
+        return 1;
+    }
+    print_header(config);
+    for (size_t s = 0; s < config.sizes.size(); s++) {
+        long size = config.sizes[s];
+        long ops = config.ops > 0 ? config.ops : std::max(size, 1000000L);
+        for (size_t k = 0; k < config.keys.size(); k++) {
+            for (size_t d = 0; d < config.dists.size(); d++) {
+                key_set set;
+                make_keys(set, config.keys[k], config.dists[d], size, ops, config.seed);
+                for (size_t m = 0; m < config.maps.size(); m++) {
+                    for (size_t l = 0; l < config.load_factors.size(); l++) {
+                        /* yy_map always resizes at 0.75 */
+                        double load_factor = config.maps[m] == "yy_map" ? 0.75 : config.load_factors[l];
+                        if (config.maps[m] == "yy_map" && l > 0) break;
+                        if (!run_map(config.maps[m], set, load_factor, &result)) {
+                            fprintf(stderr, "unknown map: %s\n", config.maps[m].c_str());
+                            return 1;
+                        }
+                        print_result(config, config.maps[m], config.keys[k], config.dists[d], size, load_factor, result, first);
+                        first = false;
+                    }
+                }
+            }
+        }
+    }
+    if (config.json) printf("\n]\n");
+    return 0;
+}
@@ -0,0 +1,395 @@
+//
+//  timer_benchmark.c
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+//  Benchmark of yy_timer_wheel against a sorted yy_array (binary search +
+//  yy_array_insert, pop at the front) and yy_heap: schedule, cancel, advance
+//  (fire every timer in steps) and churn (every fired timer is scheduled
+//  again, like a sequencer), with random times over a horizon of ticks.
+//  Results are written as CSV (default) or JSON.
+//
+//  usage: timer_benchmark [--sizes 1000,100000] [--queues wheel,heap,array]
+//                         [--horizon N] [--step N] [--ops N] [--seed N] [--format csv|json]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "yy_array.h"
+#include "yy_heap.h"
+#include "yy_timer_wheel.h"
+#include "benchmark_util.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Utility                                  ///
+////////////////////////////////////////////////////////////////////////////////
+
+static double now_seconds() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static inline uint64_t random_next(uint64_t *state) {
+    uint64_t x = (*state += 0x9E3779B97F4A7C15ULL);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/// Parse a comma separated list of numbers, returns the count (0 on error).
+static long parse_longs(const char *list, long *values, long max) {
+    long count = 0;
+    char *end;
+    while (*list) {
+        if (count == max) return 0;
+        values[count++] = strtol(list, &end, 10);
+        if (end == list || (*end != ',' && *end != '\0')) return 0;
+        list = *end ? end + 1 : end;
+    }
+    return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                                 Queues                                   ///
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct _bench_timer {
+    uint64_t time;
+    long handle;    ///< wheel and heap handle
+} bench_timer;
+
+typedef struct _bench_queue bench_queue;
+
+/// Called for every fired timer.
+typedef void (*bench_fire_func)(bench_queue *queue, bench_timer *timer);
+
+/// A timer queue, implemented with one of the containers.
+struct _bench_queue {
+    yy_timer_wheel_t *wheel;
+    yy_heap_t *heap;
+    yy_array_t *array;
+    bench_fire_func fire;
+    long fired;
+    uint64_t random;
+    uint64_t horizon;
+};
+
+static yy_order bench_timer_compare(const void *value1, const void *value2, void *context) {
+    const bench_timer *timer1 = value1, *timer2 = value2;
+    (void)context;
+    if (timer1->time < timer2->time) return YY_ORDER_ASC;
+    if (timer1->time > timer2->time) return YY_ORDER_DESC;
+    return YY_ORDER_EQUAL;
+}
+
+/// Index of the first timer later than time (timers at the same time stay in schedule order).
+static long sorted_array_upper_bound(yy_array_t *array, uint64_t time) {
+    long low = 0, high = yy_array_count_unsafe(array);
+    while (low < high) {
+        long mid = (low + high) >> 1;
+        const bench_timer *timer = yy_array_get_unsafe(array, mid);
+        if (timer->time <= time) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static bool queue_create(bench_queue *queue, const char *name) {
+    memset(queue, 0, sizeof(*queue));
+    if (strcmp(name, "wheel") == 0) {
+        queue->wheel = yy_timer_wheel_create(0);
+    } else if (strcmp(name, "heap") == 0) {
+        queue->heap = yy_heap_create(bench_timer_compare, NULL);
+    } else if (strcmp(name, "array") == 0) {
+        queue->array = yy_array_create();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void queue_destroy(bench_queue *queue) {
+    if (queue->wheel) yy_release(queue->wheel);
+    if (queue->heap) yy_release(queue->heap);
+    if (queue->array) yy_release(queue->array);
+}
+
+static inline void queue_schedule(bench_queue *queue, bench_timer *timer) {
+    if (queue->wheel) {
+        timer->handle = yy_timer_wheel_schedule(queue->wheel, timer->time, timer);
+    } else if (queue->heap) {
+        timer->handle = yy_heap_push(queue->heap, timer);
+    } else {
+        yy_array_insert(queue->array, sorted_array_upper_bound(queue->array, timer->time), timer);
+    }
+}
+
+static inline void queue_cancel(bench_queue *queue, bench_timer *timer) {
+    if (queue->wheel) {
+        yy_timer_wheel_cancel(queue->wheel, timer->handle, NULL);
+    } else if (queue->heap) {
+        yy_heap_remove(queue->heap, timer->handle, NULL);
+    } else {
+        /* first timer at this time, then scan the timers at the same time */
+        long index = timer->time ? sorted_array_upper_bound(queue->array, timer->time - 1) : 0;
+        long count = yy_array_count_unsafe(queue->array);
+        for (; index < count; index++) {
+            if (yy_array_get_unsafe(queue->array, index) == timer) {
+                yy_array_remove(queue->array, index);
+                break;
+            }
+        }
+    }
+}
+
+static void wheel_fire(long handle, uint64_t time, const void *value, void *context) {
+    bench_queue *queue = context;
+    (void)handle;
+    (void)time;
+    queue->fired++;
+    if (queue->fire) queue->fire(queue, (bench_timer *)value);
+}
+
+/// Fire every timer whose time is <= now.
+static void queue_advance(bench_queue *queue, uint64_t now) {
+    const void *value;
+    bench_timer *timer;
+
+    if (queue->wheel) {
+        yy_timer_wheel_advance(queue->wheel, now, wheel_fire, queue);
+    } else if (queue->heap) {
+        while ((timer = (bench_timer *)yy_heap_peek(queue->heap)) && timer->time <= now) {
+            yy_heap_pop(queue->heap, &value);
+            queue->fired++;
+            if (queue->fire) queue->fire(queue, timer);
+        }
+    } else {
+        while (yy_array_count_unsafe(queue->array) > 0) {
+            timer = (bench_timer *)yy_array_get_unsafe(queue->array, 0);
+            if (timer->time > now) break;
+            yy_array_pop_front(queue->array, &value);
+            queue->fired++;
+            if (queue->fire) queue->fire(queue, timer);
+        }
+    }
+}
+
+/// Churn: schedule the fired timer again, between 1 and horizon ticks later.
+static void churn_fire(bench_queue *queue, bench_timer *timer) {
+    timer->time += 1 + random_next(&queue->random) % queue->horizon;
+    queue_schedule(queue, timer);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+///                                Benchmark                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+#define MAX_ITEMS 16
+
+typedef struct _bench_config {
+    long sizes[MAX_ITEMS];
+    long size_count;
+    const char *queues[MAX_ITEMS];
+    long queue_count;
+    uint64_t horizon;
+    uint64_t step;
+    long ops;
+    uint64_t seed;
+    bool json;
+} bench_config;
+
+typedef struct _bench_result {
+    double schedule_mops;
+    double cancel_mops;
+    double advance_mops;
+    double churn_mops;
+    double bytes_per_timer;
+} bench_result;
+
+static bool run(const bench_config *config, const char *name, long size, bench_result *result) {
+    bench_queue queue;
+    bench_timer *timers;
+    long *order;
+    long i, j, tmp, ops, bytes;
+    uint64_t random = config->seed, now;
+    double t0;
+
+    timers = malloc(size * sizeof(bench_timer));
+    order = malloc(size * sizeof(long));
+    for (i = 0; i < size; i++) {
+        timers[i].time = 1 + random_next(&random) % config->horizon;
+        timers[i].handle = YY_NOT_FOUND;
+        order[i] = i;
+    }
+    for (i = size - 1; i > 0; i--) {
+        j = random_next(&random) % (i + 1);
+        tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+    }
+
+    /* schedule all, cancel half in random order, fire the rest */
+    bytes = heap_bytes();
+    if (!queue_create(&queue, name)) {
+        free(timers);
+        free(order);
+        return false;
+    }
+    t0 = now_seconds();
+    for (i = 0; i < size; i++) queue_schedule(&queue, &timers[i]);
+    result->schedule_mops = size / (now_seconds() - t0) / 1e6;
+    result->bytes_per_timer = (double)(heap_bytes() - bytes) / size;
+
+    t0 = now_seconds();
+    for (i = 0; i < size / 2; i++) queue_cancel(&queue, &timers[order[i]]);
+    result->cancel_mops = (size / 2) / (now_seconds() - t0) / 1e6;
+
+    t0 = now_seconds();
+    for (now = config->step; now < config->horizon + config->step; now += config->step) {
+        queue_advance(&queue, now);
+    }
+    result->advance_mops = queue.fired / (now_seconds() - t0) / 1e6;
+    if (queue.fired != size - size / 2) {
+        fprintf(stderr, "%s: fired %ld of %ld timers\n", name, queue.fired, size - size / 2);
+    }
+    queue_destroy(&queue);
+
+    /* churn: `size` timers pending, every fired timer is scheduled again */
+    ops = config->ops > 0 ? config->ops : (size * 2 > 1000000 ? size * 2 : 1000000);
+    queue_create(&queue, name);
+    queue.fire = churn_fire;
+    queue.random = random;
+    queue.horizon = config->horizon;
+    for (i = 0; i < size; i++) queue_schedule(&queue, &timers[i]);
+    t0 = now_seconds();
+    for (now = config->step; queue.fired < ops; now += config->step) {
+        queue_advance(&queue, now);
+    }
+    result->churn_mops = queue.fired / (now_seconds() - t0) / 1e6;
+    queue_destroy(&queue);
+
+    free(timers);
+    free(order);
+    return true;
+}
+
+static void print_header(const bench_config *config) {
+    if (config->json) {
+        printf("[\n");
+    } else {
+        printf("queue,size,horizon,step,schedule_mops,cancel_mops,advance_mops,churn_mops,bytes_per_timer\n");
+    }
+}
+
+static void print_result(const bench_config *config, const char *queue, long size, const bench_result *r, bool first) {
+    if (config->json) {
+        printf("%s  {\"queue\": \"%s\", \"size\": %ld, \"horizon\": %llu, \"step\": %llu, "
+               "\"schedule_mops\": %.3f, \"cancel_mops\": %.3f, \"advance_mops\": %.3f, \"churn_mops\": %.3f, "
+               "\"bytes_per_timer\": %.1f}",
+               first ? "" : ",\n", queue, size, (unsigned long long)config->horizon, (unsigned long long)config->step,
+               r->schedule_mops, r->cancel_mops, r->advance_mops, r->churn_mops, r->bytes_per_timer);
+    } else {
+        printf("%s,%ld,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.1f\n",
+               queue, size, (unsigned long long)config->horizon, (unsigned long long)config->step,
+               r->schedule_mops, r->cancel_mops, r->advance_mops, r->churn_mops, r->bytes_per_timer);
+    }
+    fflush(stdout);
+}
+
+static void usage() {
+    fprintf(stderr, "usage: timer_benchmark [--sizes 1000,100000] [--queues wheel,heap,array]\n"
+                    "                       [--horizon N] [--step N] [--ops N] [--seed N] [--format csv|json]\n"
+                    "sizes go from 1000 to 100000000 (the sorted array is O(n) per timer, keep it below 1000000),\n"
+                    "timers are due in [1, horizon] ticks (default 1000000), the queues are advanced by `step`\n"
+                    "ticks (default 16), ops is the number of churn fires (default max(2 * size, 1000000)).\n");
+}
+
+static bool parse_args(int argc, const char *argv[], bench_config *config) {
+    static char queues[256];
+    char *queue;
+    long i;
+
+    config->sizes[0] = 1000;
+    config->sizes[1] = 10000;
+    config->sizes[2] = 100000;
+    config->size_count = 3;
+    config->queues[0] = "wheel";
+    config->queues[1] = "heap";
+    config->queues[2] = "array";
+    config->queue_count = 3;
+    config->horizon = 1000000;
+    config->step = 16;
+    config->ops = 0;
+    config->seed = 20140529;
+    config->json = false;
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 >= argc) return false;
+        const char *arg = argv[i], *value = argv[++i];
+        if (strcmp(arg, "--sizes") == 0) {
+            config->size_count = parse_longs(value, config->sizes, MAX_ITEMS);
+            if (config->size_count == 0) return false;
+            for (long j = 0; j < config->size_count; j++) {
+                if (config->sizes[j] < 1000 || config->sizes[j] > 100000000) return false;
+            }
+        } else if (strcmp(arg, "--queues") == 0) {
+            if (strlen(value) >= sizeof(queues)) return false;
+            strcpy(queues, value);
+            config->queue_count = 0;
+            for (queue = strtok(queues, ","); queue; queue = strtok(NULL, ",")) {
+                if (config->queue_count == MAX_ITEMS) return false;
+                if (strcmp(queue, "wheel") && strcmp(queue, "heap") && strcmp(queue, "array")) return false;
+                config->queues[config->queue_count++] = queue;
+            }
+            if (config->queue_count == 0) return false;
+        } else if (strcmp(arg, "--horizon") == 0) {
+            config->horizon = strtoull(value, NULL, 10);
+            if (config->horizon == 0) return false;
+        } else if (strcmp(arg, "--step") == 0) {
+            config->step = strtoull(value, NULL, 10);
+            if (config->step == 0) return false;
+        } else if (strcmp(arg, "--ops") == 0) {
+            config->ops = atol(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            config->seed = strtoull(value, NULL, 10);
+        } else if (strcmp(arg, "--format") == 0) {
+            config->json = strcmp(value, "json") == 0;
+            if (!config->json && strcmp(value, "csv") != 0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, const char *argv[]) {
+    bench_config config;
+    bench_result result;
+    bool first = true;
+    long s, q;
+
+    if (!parse_args(argc, argv, &config)) {
+        usage();
+        return 1;
+    }
+    print_header(&config);
+    for (s = 0; s < config.size_count; s++) {
+        for (q = 0; q < config.queue_count; q++) {
+            if (!run(&config, config.queues[q], config.sizes[s], &result)) {
+                fprintf(stderr, "unknown queue: %s\n", config.queues[q]);
+                return 1;
+            }
+            print_result(&config, config.queues[q], config.sizes[s], &result, first);
+            first = false;
+        }
+    }
+    if (config.json) printf("\n]\n");
+    return 0;
+}
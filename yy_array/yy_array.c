@@ -10,6 +10,9 @@
 #include "yy_base_private.h"
 #include "yy_log.h"
 #include "yy_sort.h"
+#include "yy_file_private.h"
+#include "yy_executor.h"
+#include "yy_stats_private.h"
 
 #include <string.h>
 #include <limits.h>
@@ -31,14 +34,57 @@ yy_array_callback_t yy_array_object_callback = {
     NULL,
 };
 
+/// Slots allocated together with a small array, used until it overflows.
+#define YY_ARRAY_INLINE_CAPACITY 8
+
+/// Values per chunk of the parallel functions if no grain is given.
+#define YY_ARRAY_PARALLEL_GRAIN 4096
+
+/**
+ * Shared by the arrays created with yy_array_create_copy(), which reference
+ * the same ring until one of them is modified (copy on write).
+ * The values in a shared ring are retained once for all of the sharers.
+ */
+typedef struct _yy_array_share {
+    long ref_count;
+} yy_array_share_t;
+
+/**
+ * The fields up to `view` are yy_array_head_t (yy_array.h), read by the
+ * inline functions of the header.
+ */
 struct _yy_array {
     long count;
-    long capacity;
+    long capacity;          ///< power of 2 (or 0 without ring)
     long index;
     const void **ring;
+    long gap;               ///< logical index of the free slots, LONG_MAX if they follow the last value
+    yy_file_view_t *view;   ///< read-only strings mapped from file (ring is unused)
+    yy_array_share_t *share;
     yy_array_callback_t callback;
+    long embedded_capacity; ///< slots allocated right after the struct
+    bool gap_mode;          ///< keep the free slots at the last edit position
+    long bound;             ///< maximum count of a bounded array (0 if not bounded)
+    yy_array_evict_func evict;
+    void *evict_context;
+#ifdef YY_ENABLE_STATS
+    yy_stats_t stats;
+#endif
 };
 
+/* compile time check of the header layout, every field of yy_array_head_t */
+#define YY_ARRAY_HEAD_SAME(field) (offsetof(yy_array_t, field) == offsetof(yy_array_head_t, field))
+typedef char _yy_array_head_check[(YY_ARRAY_HEAD_SAME(count)
+                                   && YY_ARRAY_HEAD_SAME(capacity)
+                                   && YY_ARRAY_HEAD_SAME(index)
+                                   && YY_ARRAY_HEAD_SAME(ring)
+                                   && YY_ARRAY_HEAD_SAME(gap)
+                                   && YY_ARRAY_HEAD_SAME(view)
+                                   && sizeof(yy_array_head_t) <= offsetof(yy_array_t, share)) ? 1 : -1];
+#undef YY_ARRAY_HEAD_SAME
+
+static void _yy_array_dealloc(yy_array_t *array);
+
 /**
  * Validate range and log error.
  *
@@ -91,19 +137,102 @@ yy_inline bool _yy_array_validate_index(yy_array_t *array, long index, bool edge
     return true;
 }
 
+/**
+ * Arrays mapped from file cannot be modified.
+ */
+yy_inline bool _yy_array_validate_mutable(yy_array_t *array, const char *func) {
+    if (array->view) {
+        yy_log_error("yy_array_t(%p):%s() array is read-only (mapped from file)",
+                     array, func);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Get a value of an array mapped from file.
+ */
+yy_inline const void * _yy_array_view_get(yy_array_t *array, long index) {
+    return _yy_file_view_string(array->view, ((const uint64_t *)array->view->table)[index]);
+}
+
+yy_inline const void ** _yy_array_embedded_ring(yy_array_t *array) {
+    return (const void **)(array + 1);
+}
+
+/**
+ * Bytes held by the array (a shared ring is counted by each sharer).
+ */
+yy_inline long _yy_array_memory_size(yy_array_t *array) {
+    long size = sizeof(yy_array_t) + array->embedded_capacity * sizeof(void *);
+    if (array->ring && array->ring != _yy_array_embedded_ring(array)) {
+        size += array->capacity * sizeof(void *);
+    }
+    return size;
+}
+
+/**
+ * Free the ring if it was allocated out of the object.
+ */
+yy_inline void _yy_array_free_ring(yy_array_t *array) {
+    if (array->ring && array->ring != _yy_array_embedded_ring(array)) {
+        free(array->ring);
+    }
+}
+
+/**
+ * Reset an empty array to its embedded slots (or no ring at all).
+ */
+yy_inline void _yy_array_reset_ring(yy_array_t *array) {
+    array->ring = array->embedded_capacity > 0 ? _yy_array_embedded_ring(array) : NULL;
+    array->capacity = array->embedded_capacity;
+    array->index = 0;
+    array->gap = LONG_MAX;
+    YY_REGISTRY_SET_BYTES(array, _yy_array_memory_size(array));
+}
+
+/**
+ * Allocate an array with `embedded_capacity` slots in the same block.
+ */
+static yy_array_t * _yy_array_alloc(long embedded_capacity, const yy_array_callback_t *callback, const char *func) {
+    yy_array_t *array;
+    size_t size;
+    
+    size = sizeof(yy_array_t) + embedded_capacity * sizeof(void *);
+    array = _yy_alloc_named(size, (void *(*)(void *))_yy_array_dealloc, "yy_array_t");
+    if (array == NULL) {
+        yy_log_error("yy_array_t:%s() attempt to allocate %ld bytes failed",
+                     func, size);
+        return NULL;
+    }
+    array->embedded_capacity = embedded_capacity;
+    _yy_array_reset_ring(array);
+    if (callback) array->callback = *callback;
+    return array;
+}
+
 /**
  * Expand capacity to fit 2^x.
  */
 yy_inline long _yy_array_capacity_expand(long capacity) {
     int i = 1;
     if (capacity < 16) return 16;
-    else if (capacity >= (LONG_MAX >> 1)) return LONG_MAX;
+    else if (capacity > (LONG_MAX >> 1)) return (LONG_MAX >> 1) + 1;
     while ((capacity >>= 1)) i++;
     return 1L << i;
 }
 
+/**
+ * Get the ring offset of the value at index (skip the gap).
+ */
+yy_inline long _yy_array_ring_offset(yy_array_t *array, long index) {
+    if (index >= array->gap) index += array->capacity - array->count;
+    return (array->index + index) & (array->capacity - 1);
+}
+
 /**
  * Split ring's range to absolute offset.
+ * The range should not span the gap (see _yy_array_move_gap).
  *
  * @param range the range of array
  * @param abs1  absolute offset 1
@@ -112,8 +241,8 @@ yy_inline long _yy_array_capacity_expand(long capacity) {
 yy_inline void _yy_array_split(yy_array_t *array, yy_range range, yy_range *abs1, yy_range *abs2) {
     abs1->location = array->index + range.location;
     abs1->length = range.length;
-    while (abs1->location >= array->capacity) abs1->location -= array->capacity;
-    while (abs1->location < 0) abs1->location += array->capacity;
+    if (range.location >= array->gap) abs1->location += array->capacity - array->count;
+    abs1->location &= array->capacity - 1;
     
     abs2->location = abs1->location + range.length;
     if (abs2->location >= array->capacity) {
@@ -151,6 +280,8 @@ yy_inline void _yy_array_move_range(yy_array_t *array, yy_range range, long move
      */
     yy_range src1, src2, dest1, dest2;
     
+    YY_STATS_ADD(&array->stats, moves, range.length);
+    YY_STATS_ADD(&array->stats, moved_bytes, range.length * sizeof(void *));
     _yy_array_split(array, range, &src1, &src2);
     range.location += move;
     _yy_array_split(array, range, &dest1, &dest2);
@@ -216,11 +347,42 @@ yy_inline void _yy_array_move_range(yy_array_t *array, yy_range range, long move
     }
 }
 
-yy_inline void _yy_array_release_range(yy_array_t *array, yy_range range) {
+/**
+ * Move the free slots of the ring to index `gap` (gap buffer mode).
+ * The values between the old and the new position are shifted over the gap,
+ * moving the gap to array->count restores the normal ring layout.
+ */
+static void _yy_array_move_gap(yy_array_t *array, long gap) {
+    long old_gap, length, mask, i;
+    
+    old_gap = YY_MIN(array->gap, array->count);
+    length = array->capacity - array->count;
+    mask = array->capacity - 1;
+    if (length > 0) {
+        YY_STATS_ADD(&array->stats, moves, YY_ABS(gap - old_gap));
+        YY_STATS_ADD(&array->stats, moved_bytes, YY_ABS(gap - old_gap) * sizeof(void *));
+    }
+    if (length > 0 && gap < old_gap) {
+        for (i = old_gap - 1; i >= gap; i--) {
+            array->ring[(array->index + i + length) & mask] = array->ring[(array->index + i) & mask];
+        }
+    } else if (length > 0 && gap > old_gap) {
+        for (i = old_gap; i < gap; i++) {
+            array->ring[(array->index + i) & mask] = array->ring[(array->index + i + length) & mask];
+        }
+    }
+    array->gap = gap < array->count ? gap : LONG_MAX;
+}
+
+static void _yy_array_release_range(yy_array_t *array, yy_range range) {
     const void **item;
-    int i;
+    long i;
     yy_range src1, src2;
     
+    if (range.location < array->gap && range.location + range.length > array->gap) {
+        _yy_array_release_range(array, yy_range_make(range.location, array->gap - range.location));
+        range = yy_range_make(array->gap, range.location + range.length - array->gap);
+    }
     _yy_array_split(array, range, &src1, &src2);
     if (src1.length > 0) {
         item = array->ring + src1.location;
@@ -236,6 +398,132 @@ yy_inline void _yy_array_release_range(yy_array_t *array, yy_range range) {
     }
 }
 
+/**
+ * Give the array a private ring before it is modified.
+ * The deferred retain of every value is done here.
+ */
+static bool _yy_array_unshare(yy_array_t *array) {
+    const void **new_ring;
+    yy_range part[2], src1, src2;
+    long i, p;
+    
+    /* the other sharers are gone, the ring and its references are ours */
+    if (__sync_fetch_and_add(&array->share->ref_count, 0) == 1) {
+        free(array->share);
+        array->share = NULL;
+        return true;
+    }
+    
+    new_ring = malloc(array->capacity * sizeof(void *));
+    if (new_ring == NULL) {
+        yy_log_error("yy_array_t(%p):%s() attempt to allocate %ld bytes failed",
+                     array, __func__, array->capacity * sizeof(void *));
+        return false;
+    }
+    YY_STATS_ADD(&array->stats, reallocs, 1);
+    YY_STATS_ADD(&array->stats, realloc_bytes, array->capacity * sizeof(void *));
+    /* keep the layout, values on both sides of the gap */
+    part[0] = yy_range_make(0, YY_MIN(array->gap, array->count));
+    part[1] = yy_range_make(part[0].length, array->count - part[0].length);
+    for (p = 0; p < 2; p++) {
+        _yy_array_split(array, part[p], &src1, &src2);
+        if (src1.length > 0) {
+            memcpy(new_ring + src1.location,
+                   array->ring + src1.location,
+                   src1.length * sizeof(void *));
+        }
+        if (src2.length > 0) {
+            memcpy(new_ring + src2.location,
+                   array->ring + src2.location,
+                   src2.length * sizeof(void *));
+        }
+        if (array->callback.retain != NULL) {
+            for (i = src1.location; i < src1.location + src1.length; i++) {
+                new_ring[i] = array->callback.retain(new_ring[i]);
+            }
+            for (i = src2.location; i < src2.location + src2.length; i++) {
+                new_ring[i] = array->callback.retain(new_ring[i]);
+            }
+        }
+    }
+    
+    if (__sync_sub_and_fetch(&array->share->ref_count, 1) == 0) {
+        /* the last other sharer left while we were copying */
+        if (array->callback.release) _yy_array_release_range(array, yy_range_make(0, array->count));
+        free(array->ring);
+        free(array->share);
+    }
+    array->ring = new_ring;
+    array->share = NULL;
+    YY_REGISTRY_SET_BYTES(array, _yy_array_memory_size(array));
+    return true;
+}
+
+/**
+ * Leave the shared ring without touching it (the array is being cleared).
+ *
+ * @return true if the array was the last sharer and now owns the ring.
+ */
+static bool _yy_array_leave_share(yy_array_t *array) {
+    if (__sync_sub_and_fetch(&array->share->ref_count, 1) == 0) {
+        free(array->share);
+        array->share = NULL;
+        return true;
+    }
+    array->share = NULL;
+    array->count = 0;
+    _yy_array_reset_ring(array);
+    return false;
+}
+
+/**
+ * Dispose of a value evicted from a bounded array.
+ */
+yy_inline void _yy_array_evict_value(yy_array_t *array, const void *value) {
+    if (array->evict) array->evict(value, array->evict_context);
+    else if (array->callback.release) array->callback.release(value);
+}
+
+/**
+ * Evict the first `count` values of a bounded array (the gap must be at the end).
+ */
+static void _yy_array_evict_front(yy_array_t *array, long count) {
+    long i, index, mask;
+    
+    mask = array->capacity - 1;
+    index = array->index;
+    array->index = (index + count) & mask;
+    array->count -= count;
+    for (i = 0; i < count; i++) {
+        _yy_array_evict_value(array, array->ring[(index + i) & mask]);
+    }
+}
+
+/**
+ * Append to a full bounded array: the value takes the slot after the last
+ * value and the ring start moves over the oldest one, in O(1).
+ */
+static bool _yy_array_overwrite_oldest(yy_array_t *array, const void *value, bool retain) {
+    const void *evicted;
+    long mask;
+    
+    if (array->share && !_yy_array_unshare(array)) {
+        return false;
+    }
+    if (array->gap != LONG_MAX) {
+        _yy_array_move_gap(array, array->count);
+    }
+    if (retain && array->callback.retain) {
+        value = array->callback.retain(value);
+    }
+    mask = array->capacity - 1;
+    evicted = array->ring[array->index];
+    array->ring[(array->index + array->count) & mask] = value;
+    array->index = (array->index + 1) & mask;
+    _yy_array_evict_value(array, evicted);
+    return true;
+}
+
 static bool _yy_array_reposition_ring_regions(yy_array_t *array, yy_range range,long new_length) {
     const void **new_ring;
     long old_count, old_capacity, new_capacity, new_index, move;
@@ -259,7 +547,9 @@ static bool _yy_array_reposition_ring_regions(yy_array_t *array, yy_range range,
                          array, __func__, new_capacity * sizeof(void *));
             return false;
         }
-
+        YY_STATS_ADD(&array->stats, reallocs, 1);
+        YY_STATS_ADD(&array->stats, realloc_bytes, new_capacity * sizeof(void *));
+        
         if (l_used > 0) {
             _yy_array_split(array, yy_range_make(0, l_used), &src1, &src2);
             if (src1.length > 0) {
@@ -287,19 +577,18 @@ static bool _yy_array_reposition_ring_regions(yy_array_t *array, yy_range range,
             }
         }
         
-        free(array->ring);
+        _yy_array_free_ring(array);
         array->ring = new_ring;
         array->index = new_index;
         array->capacity = new_capacity;
+        YY_REGISTRY_SET_BYTES(array, _yy_array_memory_size(array));
         return true;
     }
     
     if (l_used < r_used) {
         move = old_length - new_length;
         _yy_array_move_range(array, yy_range_make(0, l_used), move);
-        new_index = array->index + move;
-        while (new_index < 0) new_index += array->capacity;
-        while (new_index >= array->capacity) new_index -= array->capacity;
+        new_index = (array->index + move) & (array->capacity - 1);
     } else {
         move = new_length - old_length;
         _yy_array_move_range(array, yy_range_make(l_used + old_length, r_used), move);
@@ -309,14 +598,28 @@ static bool _yy_array_reposition_ring_regions(yy_array_t *array, yy_range range,
     return true;
 }
 
-static bool _yy_array_replace_values(yy_array_t *array, yy_range range, const void **new_values, long new_length) {
+/**
+ * Replace the values in range.
+ * Without `retain`, the array adopts the references of new_values (transfer in).
+ * Without `release`, the references of the replaced values go back to the caller (transfer out).
+ */
+static bool _yy_array_replace_values_with_options(yy_array_t *array, yy_range range,
+                                                  const void **new_values, long new_length,
+                                                  bool retain, bool release) {
     const void *buffer[64];
-    const void **new_values_retained;
+    const void **new_values_retained, **stored_values;
     bool retained_need_free;
     bool result;
-    long i, old_count, new_count, old_capacity, new_capacity;
+    long i, mask, old_count, new_count, old_capacity, new_capacity, excess, front;
     yy_range dest1, dest2;
     
+    if (!_yy_array_validate_mutable(array, __func__)) {
+        return false;
+    }
+    if (array->share && !_yy_array_unshare(array)) {
+        return false;
+    }
+    
     old_count = array->count;
     new_count = old_count - range.length + new_length;
     old_capacity = array->capacity;
@@ -330,13 +633,16 @@ static bool _yy_array_replace_values(yy_array_t *array, yy_range range, const vo
                          array, __func__, new_capacity * sizeof(void *));
             return false;
         }
+        YY_STATS_ADD(&array->stats, reallocs, 1);
+        YY_STATS_ADD(&array->stats, realloc_bytes, new_capacity * sizeof(void *));
         array->index = 0;
         array->capacity = new_capacity;
+        YY_REGISTRY_SET_BYTES(array, _yy_array_memory_size(array));
     }
     
     /**************************** retain and release **************************/
     retained_need_free = false;
-    if (new_length > 0 && array->callback.retain) {
+    if (new_length > 0 && retain && array->callback.retain) {
         if (new_length <= 64) {
             new_values_retained = buffer;
         } else {
@@ -355,10 +661,48 @@ static bool _yy_array_replace_values(yy_array_t *array, yy_range range, const vo
         new_values_retained = new_values;
     }
     
-    if (range.length > 0 && array->callback.release) {
+    if (range.length > 0 && release && array->callback.release) {
         _yy_array_release_range(array, range);
     }
     
+    /**************************** bounded *************************************/
+    stored_values = new_values_retained;
+    if (array->bound > 0 && new_count > array->bound) {
+        /* the result keeps its last `bound` values: evict the values before
+           the range first, then the first new values (never stored) */
+        excess = new_count - array->bound;
+        front = YY_MIN(excess, range.location);
+        if (array->gap != LONG_MAX) {
+            _yy_array_move_gap(array, old_count);
+        }
+        _yy_array_evict_front(array, front);
+        for (i = 0; i < excess - front; i++) {
+            _yy_array_evict_value(array, new_values_retained[i]);
+        }
+        stored_values += excess - front;
+        new_length -= excess - front;
+        range.location -= front;
+        old_count -= front;
+        new_count = array->bound;
+    }
+    
+    /**************************** gap buffer **********************************/
+    if (array->gap_mode && new_count <= array->capacity) {
+        /* the replaced values end at the gap, overwrite them and grow into the gap */
+        _yy_array_move_gap(array, range.location + range.length);
+        mask = array->capacity - 1;
+        for (i = 0; i < new_length; i++) {
+            array->ring[(array->index + range.location + i) & mask] = stored_values[i];
+        }
+        if (retained_need_free) free(new_values_retained);
+        array->count = new_count;
+        array->gap = range.location + new_length < new_count ? range.location + new_length : LONG_MAX;
+        return true;
+    }
+    if (array->gap != LONG_MAX) {
+        _yy_array_move_gap(array, old_count);
+    }
+    
     /**************************** resposition regions *************************/
     if (old_capacity > 0 && range.length != new_length) {
         result = _yy_array_reposition_ring_regions(array, range, new_length);
@@ -373,22 +717,20 @@ static bool _yy_array_replace_values(yy_array_t *array, yy_range range, const vo
         _yy_array_split(array, yy_range_make(range.location, new_length), &dest1, &dest2);
         if (dest1.length > 0) {
             memmove(array->ring + dest1.location,
-                    new_values_retained,
+                    stored_values,
                     dest1.length * sizeof(void *));
         }
         if (dest2.length > 0) {
             memmove(array->ring + dest2.location,
-                    new_values_retained + dest1.length,
+                    stored_values + dest1.length,
                     dest2.length * sizeof(void *));
         }
     }
     
     /**************************** finish **************************************/
     if (new_count == 0 && array->ring) {
-        free(array->ring);
-        array->index = 0;
-        array->ring = NULL;
-        array->capacity = 0;
+        _yy_array_free_ring(array);
+        _yy_array_reset_ring(array);
     }
     if (retained_need_free) free(new_values_retained);
     
@@ -396,13 +738,46 @@ static bool _yy_array_replace_values(yy_array_t *array, yy_range range, const vo
     return true;
 }
 
+yy_inline bool _yy_array_replace_values(yy_array_t *array, yy_range range, const void **new_values, long new_length) {
+    return _yy_array_replace_values_with_options(array, range, new_values, new_length, true, true);
+}
+
+/**
+ * Close the free slots [location, end) left by a compaction,
+ * moving the shorter side of the ring over them (the gap must be at the end).
+ */
+static void _yy_array_close_hole(yy_array_t *array, long location, long end) {
+    long removed, tail;
+    
+    removed = end - location;
+    tail = array->count - end;
+    if (removed > 0 && location < tail) {
+        _yy_array_move_range(array, yy_range_make(0, location), removed);
+        array->index = (array->index + removed) & (array->capacity - 1);
+    } else if (removed > 0 && tail > 0) {
+        _yy_array_move_range(array, yy_range_make(end, tail), -removed);
+    }
+    array->count -= removed;
+    if (array->count == 0 && array->ring) {
+        _yy_array_free_ring(array);
+        _yy_array_reset_ring(array);
+    }
+}
+
 static void _yy_array_dealloc(yy_array_t *array) {
+    if (array->view) {
+        _yy_file_view_release(array->view);
+        yy_dealloc(array);
+        return;
+    }
+    if (array->share && !_yy_array_leave_share(array)) {
+        yy_dealloc(array);
+        return;
+    }
     if (array->callback.release && array->count > 0) {
         _yy_array_release_range(array, yy_range_make(0, array->count));
     }
-    if (array->ring) {
-        free(array->ring);
-    }
+    _yy_array_free_ring(array);
     yy_dealloc(array);
 }
 
@@ -426,11 +801,12 @@ yy_array_t * yy_array_create_with_options(long capacity, const yy_array_callback
                      __func__, capacity);
         return NULL;
     }
-    array = yy_alloc(yy_array_t, _yy_array_dealloc);
+    if (capacity <= YY_ARRAY_INLINE_CAPACITY) {
+        return _yy_array_alloc(YY_ARRAY_INLINE_CAPACITY, callback, __func__);
+    }
     
+    array = _yy_array_alloc(0, callback, __func__);
     if (array == NULL) {
-        yy_log_error("yy_array_t:%s() attempt to allocate %ld bytes failed",
-                     __func__, sizeof(yy_array_t));
         return NULL;
     }
     if (capacity > 0) {
@@ -443,16 +819,69 @@ yy_array_t * yy_array_create_with_options(long capacity, const yy_array_callback
             return NULL;
         }
         array->capacity = capacity;
+        YY_REGISTRY_SET_BYTES(array, _yy_array_memory_size(array));
     }
+    return array;
+}
+
+yy_array_t * yy_array_create_with_values(const void **values, long count, const yy_array_callback_t *callback) {
+    yy_array_t *array;
+    long capacity, i;
     
-    if (callback) array->callback = *callback;
+    if (count < 0) {
+        yy_log_error("%s() count(%ld) cannot be less than zero",
+                     __func__, count);
+        return NULL;
+    }
+    if (count > 0 && values == NULL) {
+        yy_log_error("%s() values cannot be null",
+                     __func__);
+        return NULL;
+    }
+    
+    /* header and ring in one block, the ring may be full */
+    capacity = YY_ARRAY_INLINE_CAPACITY;
+    while (capacity < count) capacity <<= 1;
+    array = _yy_array_alloc(capacity, callback, __func__);
+    if (array == NULL) {
+        return NULL;
+    }
+    if (array->callback.retain) {
+        for (i = 0; i < count; i++) {
+            array->ring[i] = array->callback.retain(values[i]);
+        }
+    } else if (count > 0) {
+        memcpy(array->ring, values, count * sizeof(void *));
+    }
+    array->count = count;
+    return array;
+}
+
+yy_array_t * yy_array_create_bounded(long bound, const yy_array_callback_t *callback,
+                                     yy_array_evict_func evict, void *context) {
+    yy_array_t *array;
+    
+    if (bound <= 0) {
+        yy_log_error("%s() bound(%ld) must be greater than zero",
+                     __func__, bound);
+        return NULL;
+    }
+    
+    /* the ring never grows (it always keeps a free slot), allocate it with the header */
+    array = _yy_array_alloc(_yy_array_capacity_expand(bound), callback, __func__);
+    if (array == NULL) {
+        return NULL;
+    }
+    array->bound = bound;
+    array->evict = evict;
+    array->evict_context = context;
     return array;
 }
 
 yy_array_t * yy_array_create_copy(yy_array_t *array) {
     yy_array_t *new_array;
-    yy_range src1, src2;
-    long i;
+    const void **ring;
+    long i, capacity;
     
     if (array == NULL) {
         yy_log_error("%s() input array cannot be null",
@@ -460,47 +889,78 @@ yy_array_t * yy_array_create_copy(yy_array_t *array) {
         return NULL;
     }
     
-    new_array = yy_alloc(yy_array_t, _yy_array_dealloc);
+    if (array->view == NULL && array->count <= YY_ARRAY_INLINE_CAPACITY) {
+        /* small arrays are copied right away into embedded slots */
+        capacity = array->bound > 0 ? array->capacity : YY_ARRAY_INLINE_CAPACITY;
+        while (capacity < array->count) capacity <<= 1;
+        new_array = _yy_array_alloc(capacity, &array->callback, __func__);
+        if (new_array == NULL) {
+            return NULL;
+        }
+        new_array->bound = array->bound;
+        new_array->evict = array->evict;
+        new_array->evict_context = array->evict_context;
+        new_array->gap_mode = array->gap_mode;
+        yy_array_get_range(array, yy_range_make(0, array->count), new_array->ring);
+        if (new_array->callback.retain) {
+            for (i = 0; i < array->count; i++) {
+                new_array->ring[i] = new_array->callback.retain(new_array->ring[i]);
+            }
+        }
+        new_array->count = array->count;
+        return new_array;
+    }
+    
+    new_array = _yy_array_alloc(YY_ARRAY_INLINE_CAPACITY, &array->callback, __func__);
     if (new_array == NULL) {
-        yy_log_error("yy_array_t:%s() attempt to allocate %ld bytes failed",
-                     __func__, sizeof(yy_array_t));
         return NULL;
     }
-    
-    new_array->callback = array->callback;
-    if (array->count > 0) {
-        new_array->capacity = array->capacity;
+    if (array->view) {
+        _yy_file_view_retain(array->view);
+        new_array->view = array->view;
         new_array->count = array->count;
-        new_array->index = array->index;
-        new_array->ring = malloc(array->capacity * sizeof(void *));
-        if (new_array->ring == NULL) {
+        return new_array;
+    }
+    
+    /* an embedded ring cannot outlive its array, move it out first (no retain) */
+    if (array->ring == _yy_array_embedded_ring(array)) {
+        ring = malloc(array->capacity * sizeof(void *));
+        if (ring == NULL) {
             yy_log_error("yy_array_t:%s() attempt to allocate %ld bytes failed",
                          __func__, array->capacity * sizeof(void *));
-            yy_dealloc(array);
+            yy_dealloc(new_array);
             return NULL;
         }
-        
-        _yy_array_split(array, yy_range_make(0, array->count), &src1, &src2);
-        if (src1.length > 0) {
-            memcpy(new_array->ring + src1.location,
-                   array->ring + src1.location,
-                   src1.length * sizeof(void *));
-        }
-        if (src2.length > 0) {
-            memcpy(new_array->ring + src2.location,
-                   array->ring + src2.location,
-                   src2.length * sizeof(void *));
-        }
-        if (new_array->callback.retain != NULL) {
-            for (i = src1.location; i < src1.location + src1.length; i++) {
-                new_array->ring[i] = new_array->callback.retain(new_array->ring[i]);
-            }
-            for (i = src2.location; i < src2.location + src2.length; i++) {
-                new_array->ring[i] = new_array->callback.retain(new_array->ring[i]);
-            }
-        }
+        memcpy(ring, array->ring, array->capacity * sizeof(void *));
+        array->ring = ring;
+        YY_STATS_ADD(&array->stats, reallocs, 1);
+        YY_STATS_ADD(&array->stats, realloc_bytes, array->capacity * sizeof(void *));
+        YY_REGISTRY_SET_BYTES(array, _yy_array_memory_size(array));
     }
     
+    /* share the ring, values are retained when one of the arrays is modified */
+    if (array->share == NULL) {
+        array->share = malloc(sizeof(yy_array_share_t));
+        if (array->share == NULL) {
+            yy_log_error("yy_array_t:%s() attempt to allocate %ld bytes failed",
+                         __func__, sizeof(yy_array_share_t));
+            yy_dealloc(new_array);
+            return NULL;
+        }
+        array->share->ref_count = 1;
+    }
+    __sync_fetch_and_add(&array->share->ref_count, 1);
+    new_array->share = array->share;
+    new_array->ring = array->ring;
+    new_array->capacity = array->capacity;
+    new_array->count = array->count;
+    new_array->index = array->index;
+    new_array->gap = array->gap;
+    new_array->gap_mode = array->gap_mode;
+    new_array->bound = array->bound;
+    new_array->evict = array->evict;
+    new_array->evict_context = array->evict_context;
+    YY_REGISTRY_SET_BYTES(new_array, _yy_array_memory_size(new_array));
     return new_array;
 }
 
@@ -508,8 +968,8 @@ const void * yy_array_get(yy_array_t *array, long index) {
     if (!_yy_array_validate_index(array, index, false, __func__)) {
         return NULL;
     }
-    while (array->index  + index >= array->capacity) index -= array->capacity;
-    return array->ring[array->index + index];
+    if (array->view) return _yy_array_view_get(array, index);
+    return array->ring[_yy_array_ring_offset(array, index)];
 }
 
 const void * yy_array_get_last(yy_array_t *array, long index) {
@@ -517,8 +977,8 @@ const void * yy_array_get_last(yy_array_t *array, long index) {
     if (!_yy_array_validate_index(array, index, false, __func__)) {
         return NULL;
     }
-    while (array->index  + index >= array->capacity) index -= array->capacity;
-    return array->ring[array->index + index];
+    if (array->view) return _yy_array_view_get(array, index);
+    return array->ring[_yy_array_ring_offset(array, index)];
 }
 
 long yy_array_count(yy_array_t *array) {
@@ -527,6 +987,7 @@ long yy_array_count(yy_array_t *array) {
 
 bool yy_array_get_range(yy_array_t *array, yy_range range, const void **values) {
     yy_range src1, src2;
+    long i;
     
     if (!_yy_array_validate_range(array, range, __func__)) {
         return false;
@@ -534,6 +995,18 @@ bool yy_array_get_range(yy_array_t *array, yy_range range, const void **values)
     if (range.length == 0) {
         return true;
     }
+    if (array->view) {
+        for (i = 0; i < range.length; i++) {
+            values[i] = _yy_array_view_get(array, range.location + i);
+        }
+        return true;
+    }
+    if (range.location < array->gap && range.location + range.length > array->gap) {
+        /* spans the gap, copy the left side first */
+        yy_array_get_range(array, yy_range_make(range.location, array->gap - range.location), values);
+        values += array->gap - range.location;
+        range = yy_range_make(array->gap, range.location + range.length - array->gap);
+    }
     
     _yy_array_split(array, range, &src1, &src2);
     if (src1.length > 0) {
@@ -562,6 +1035,9 @@ bool yy_array_replace_range(yy_array_t *array, yy_range range, const void **new_
 }
 
 bool yy_array_append(yy_array_t *array, const void *value) {
+    if (array->bound > 0 && array->count == array->bound) {
+        return _yy_array_overwrite_oldest(array, value, true);
+    }
     return _yy_array_replace_values(array, yy_range_make(array->count, 0), &value, 1);
 }
 
@@ -573,14 +1049,20 @@ bool yy_array_set(yy_array_t *array, long index, const void *value) {
     if (!_yy_array_validate_index(array, index, false, __func__)) {
         return false;
     }
-    while (array->index + index >= array->capacity) index -= array->capacity;
+    if (!_yy_array_validate_mutable(array, __func__)) {
+        return false;
+    }
+    if (array->share && !_yy_array_unshare(array)) {
+        return false;
+    }
+    index = _yy_array_ring_offset(array, index);
     if (array->callback.retain) {
         value = array->callback.retain(value);
     }
     if (array->callback.release) {
-        array->callback.release(array->ring[array->index + index]);
+        array->callback.release(array->ring[index]);
     }
-    array->ring[array->index + index] = value;
+    array->ring[index] = value;
     return true;
 }
 
@@ -598,6 +1080,60 @@ bool yy_array_remove(yy_array_t *array, long index) {
     return _yy_array_replace_values(array, yy_range_make(index, 1), NULL, 0);
 }
 
+bool yy_array_append_transfer(yy_array_t *array, const void *value) {
+    if (array->bound > 0 && array->count == array->bound) {
+        return _yy_array_overwrite_oldest(array, value, false);
+    }
+    return _yy_array_replace_values_with_options(array, yy_range_make(array->count, 0), &value, 1, false, true);
+}
+
+bool yy_array_insert_transfer(yy_array_t *array, long index, const void *value) {
+    if (!_yy_array_validate_index(array, index, true, __func__)) {
+        return false;
+    }
+    return _yy_array_replace_values_with_options(array, yy_range_make(index, 0), &value, 1, false, true);
+}
+
+bool yy_array_take_range(yy_array_t *array, yy_range range, const void **values) {
+    if (!_yy_array_validate_range(array, range, __func__)) {
+        return false;
+    }
+    if (values == NULL && range.length > 0) {
+        yy_log_error("yy_array_t(%p):%s() values cannot be null",
+                     array, __func__);
+        return false;
+    }
+    if (!_yy_array_validate_mutable(array, __func__)) {
+        return false;
+    }
+    
+    /* a shared ring holds references of the other arrays, take our own copies first */
+    if (array->share && !_yy_array_unshare(array)) {
+        return false;
+    }
+    if (!yy_array_get_range(array, range, values)) {
+        return false;
+    }
+    return _yy_array_replace_values_with_options(array, range, NULL, 0, false, false);
+}
+
+bool yy_array_take(yy_array_t *array, long index, const void **value) {
+    if (!_yy_array_validate_index(array, index, false, __func__)) {
+        return false;
+    }
+    return yy_array_take_range(array, yy_range_make(index, 1), value);
+}
+
+bool yy_array_pop_front(yy_array_t *array, const void **value) {
+    if (array->count == 0) return false;
+    return yy_array_take_range(array, yy_range_make(0, 1), value);
+}
+
+bool yy_array_pop_back(yy_array_t *array, const void **value) {
+    if (array->count == 0) return false;
+    return yy_array_take_range(array, yy_range_make(array->count - 1, 1), value);
+}
+
 bool yy_array_exchange(yy_array_t *array, long index1, long index2) {
     const void *tmp;
     
@@ -607,27 +1143,118 @@ bool yy_array_exchange(yy_array_t *array, long index1, long index2) {
     if (!_yy_array_validate_index(array, index2, false, __func__)) {
         return false;
     }
+    if (!_yy_array_validate_mutable(array, __func__)) {
+        return false;
+    }
+    if (array->share && !_yy_array_unshare(array)) {
+        return false;
+    }
+    
+    index1 = _yy_array_ring_offset(array, index1);
+    index2 = _yy_array_ring_offset(array, index2);
+    
+    tmp = array->ring[index1];
+    array->ring[index1] = array->ring[index2];
+    array->ring[index2] = tmp;
+    return true;
+}
+
+bool yy_array_remove_if(yy_array_t *array, yy_range range, yy_array_predicate_func predicate, void *context) {
+    const void *value;
+    long i, kept, mask;
     
-    while (array->index + index1 >= array->capacity) index1 -= array->capacity;
-    while (array->index + index2 >= array->capacity) index2 -= array->capacity;
+    if (!predicate) return false;
+    if (!_yy_array_validate_range(array, range, __func__)) return false;
+    if (!_yy_array_validate_mutable(array, __func__)) return false;
+    if (range.length == 0) return true;
+    if (array->share && !_yy_array_unshare(array)) {
+        return false;
+    }
+    if (array->gap != LONG_MAX) {
+        _yy_array_move_gap(array, array->count);
+    }
     
-    tmp = array->ring[array->index + index1];
-    array->ring[array->index + index1] = array->ring[array->index + index2];
-    array->ring[array->index + index2] = tmp;
+    /* pack the kept values to the left, release the others on the way */
+    mask = array->capacity - 1;
+    kept = range.location;
+    for (i = range.location; i < range.location + range.length; i++) {
+        value = array->ring[(array->index + i) & mask];
+        if (predicate(i, value, context)) {
+            if (array->callback.release) array->callback.release(value);
+        } else {
+            if (kept != i) array->ring[(array->index + kept) & mask] = value;
+            kept++;
+        }
+    }
+    _yy_array_close_hole(array, kept, range.location + range.length);
+    return true;
+}
+
+bool yy_array_remove_indices(yy_array_t *array, const long *indices, long count) {
+    const void *value;
+    long i, next, kept, end, mask;
+    
+    if (count < 0 || (count > 0 && indices == NULL)) {
+        yy_log_error("yy_array_t(%p):%s() invalid indices(%p) count(%ld)",
+                     array, __func__, indices, count);
+        return false;
+    }
+    if (!_yy_array_validate_mutable(array, __func__)) return false;
+    for (i = 0; i < count; i++) {
+        if (!_yy_array_validate_index(array, indices[i], false, __func__)) {
+            return false;
+        }
+        if (i > 0 && indices[i] <= indices[i - 1]) {
+            yy_log_error("yy_array_t(%p):%s() indices must be strictly ascending (%ld after %ld)",
+                         array, __func__, indices[i], indices[i - 1]);
+            return false;
+        }
+    }
+    if (count == 0) return true;
+    if (array->share && !_yy_array_unshare(array)) {
+        return false;
+    }
+    if (array->gap != LONG_MAX) {
+        _yy_array_move_gap(array, array->count);
+    }
+    
+    mask = array->capacity - 1;
+    kept = indices[0];
+    end = indices[count - 1] + 1;
+    for (i = indices[0], next = 0; i < end; i++) {
+        value = array->ring[(array->index + i) & mask];
+        if (i == indices[next]) {
+            if (array->callback.release) array->callback.release(value);
+            next++;
+        } else {
+            array->ring[(array->index + kept) & mask] = value;
+            kept++;
+        }
+    }
+    _yy_array_close_hole(array, kept, end);
     return true;
 }
 
 bool yy_array_clear(yy_array_t *array) {
+    if (array->view) {
+        /* drop the mapping, the array becomes an ordinary empty array */
+        _yy_file_view_release(array->view);
+        array->view = NULL;
+        array->count = 0;
+        return true;
+    }
     if (array->ring == NULL) {
         return true;
     }
+    if (array->share && !_yy_array_leave_share(array)) {
+        return true;
+    }
     if (array->callback.release && array->count > 0) {
         _yy_array_release_range(array, yy_range_make(0, array->count));
     }
-    free(array->ring);
-    array->capacity = 0;
+    _yy_array_free_ring(array);
+    _yy_array_reset_ring(array);
     array->count = 0;
-    array->ring = NULL;
     return true;
 }
 
@@ -637,13 +1264,30 @@ bool yy_array_contains(yy_array_t *array, const void *value) {
 
 long yy_array_get_first_index(yy_array_t *array, yy_range range, const void *value) {
     long i, index;
-    const void **item;
+    const void **item, *item_value;
     yy_range src1, src2;
     
     if (!_yy_array_validate_range(array, range, __func__) || range.length == 0) {
         return YY_NOT_FOUND;
     }
     
+    if (array->view) {
+        for (index = range.location; index < range.location + range.length; index++) {
+            item_value = _yy_array_view_get(array, index);
+            if (item_value == value
+                || (array->callback.equal && array->callback.equal(item_value, value))) {
+                return index;
+            }
+        }
+        return YY_NOT_FOUND;
+    }
+    if (range.location < array->gap && range.location + range.length > array->gap) {
+        /* spans the gap, search the left side first */
+        index = yy_array_get_first_index(array, yy_range_make(range.location, array->gap - range.location), value);
+        if (index != YY_NOT_FOUND) return index;
+        range = yy_range_make(array->gap, range.location + range.length - array->gap);
+    }
+    
     _yy_array_split(array, range, &src1, &src2);
     index = range.location;
     if (src1.length > 0) {
@@ -669,13 +1313,30 @@ long yy_array_get_first_index(yy_array_t *array, yy_range range, const void *val
 
 long yy_array_get_last_index(yy_array_t *array, yy_range range, const void *value) {
     long i, index;
-    const void **item;
+    const void **item, *item_value;
     yy_range src1, src2;
     
     if (!_yy_array_validate_range(array, range, __func__) || range.length == 0) {
         return YY_NOT_FOUND;
     }
     
+    if (array->view) {
+        for (index = range.location + range.length - 1; index >= range.location; index--) {
+            item_value = _yy_array_view_get(array, index);
+            if (item_value == value
+                || (array->callback.equal && array->callback.equal(item_value, value))) {
+                return index;
+            }
+        }
+        return YY_NOT_FOUND;
+    }
+    if (range.location < array->gap && range.location + range.length > array->gap) {
+        /* spans the gap, search the right side first */
+        index = yy_array_get_last_index(array, yy_range_make(array->gap, range.location + range.length - array->gap), value);
+        if (index != YY_NOT_FOUND) return index;
+        range = yy_range_make(range.location, array->gap - range.location);
+    }
+    
     _yy_array_split(array, range, &src1, &src2);
     index = range.location + range.length - 1;
     if (src2.length > 0) {
@@ -703,21 +1364,58 @@ bool yy_array_sort(yy_array_t *array, yy_comparator_func cmp, void *context) {
     return yy_array_sort_range(array, yy_range_make(0, array->count), cmp, context);
 }
 
+#ifdef YY_ENABLE_STATS
+typedef struct _yy_array_counted_compare {
+    yy_comparator_func cmp;
+    void *context;
+    unsigned long count;
+} yy_array_counted_compare_t;
+
+static yy_order _yy_array_counted_compare(const void *value1, const void *value2, void *context) {
+    yy_array_counted_compare_t *counted = context;
+    counted->count++;
+    return counted->cmp(value1, value2, counted->context);
+}
+#endif
+
 bool yy_array_sort_range(yy_array_t *array, yy_range range, yy_comparator_func cmp, void *context) {
+#ifdef YY_ENABLE_STATS
+    yy_array_counted_compare_t counted;
+#endif
     long move;
     
     if (!_yy_array_validate_range(array, range, __func__)) {
         return false;
     }
+    if (!_yy_array_validate_mutable(array, __func__)) return false;
     if (range.length <= 1) return true;
+    if (array->share && !_yy_array_unshare(array)) {
+        return false;
+    }
+    YY_STATS_ADD(&array->stats, sorts, 1);
+    if (array->gap != LONG_MAX) {
+        YY_STATS_ADD(&array->stats, sort_linearizations, 1);
+        _yy_array_move_gap(array, array->count);
+    }
     
-    while (array->index + range.location >= array->capacity) range.location -= array->capacity;
+    range.location = (array->index + range.location) & (array->capacity - 1);
+    range.location -= array->index;
     if (array->index + range.location + range.length > array->capacity) {
+        YY_STATS_ADD(&array->stats, sort_wraps, 1);
+        YY_STATS_ADD(&array->stats, sort_linearizations, 1);
         move = -(array->index + range.location + range.length - array->capacity);
         _yy_array_move_range(array, range, move);
         array->index += move;
     }
+#ifdef YY_ENABLE_STATS
+    counted.cmp = cmp;
+    counted.context = context;
+    counted.count = 0;
+    yy_quick_sort(array->ring + array->index + range.location, range.length, _yy_array_counted_compare, &counted);
+    YY_STATS_ADD(&array->stats, compares, counted.count);
+#else
     yy_quick_sort(array->ring + array->index + range.location, range.length, cmp, context);
+#endif
     return true;
 }
 
@@ -732,6 +1430,17 @@ bool yy_array_foreach_range(yy_array_t *array, yy_range range, yy_array_foreach_
     
     if (!func) return false;
     if (!_yy_array_validate_range(array, range, __func__)) return false;
+    if (array->view) {
+        for (index = range.location; index < range.location + range.length; index++) {
+            func(index, _yy_array_view_get(array, index), context);
+        }
+        return true;
+    }
+    if (range.location < array->gap && range.location + range.length > array->gap) {
+        /* spans the gap, walk the left side first */
+        yy_array_foreach_range(array, yy_range_make(range.location, array->gap - range.location), func, context);
+        range = yy_range_make(array->gap, range.location + range.length - array->gap);
+    }
     
     _yy_array_split(array, range, &src1, &src2);
     index = range.location;
@@ -749,3 +1458,239 @@ bool yy_array_foreach_range(yy_array_t *array, yy_range range, yy_array_foreach_
     }
     return true;
 }
+
+bool yy_array_set_gap_mode(yy_array_t *array, bool enabled) {
+    if (!_yy_array_validate_mutable(array, __func__)) {
+        return false;
+    }
+    if (!enabled && array->gap != LONG_MAX) {
+        if (array->share && !_yy_array_unshare(array)) {
+            return false;
+        }
+        _yy_array_move_gap(array, array->count);
+    }
+    array->gap_mode = enabled;
+    return true;
+}
+
+long yy_array_get_bound(yy_array_t *array) {
+    return array->bound;
+}
+
+bool yy_array_get_window(yy_array_t *array, yy_range range,
+                         const void * const **values1, long *count1,
+                         const void * const **values2, long *count2) {
+    yy_range src1, src2;
+    
+    if (!_yy_array_validate_range(array, range, __func__)) {
+        return false;
+    }
+    if (!_yy_array_validate_mutable(array, __func__)) {
+        return false;
+    }
+    if (range.location < array->gap && range.location + range.length > array->gap) {
+        /* the other sharers use the same layout, do not move their gap */
+        if (array->share && !_yy_array_unshare(array)) {
+            return false;
+        }
+        _yy_array_move_gap(array, array->count);
+    }
+    
+    if (range.length == 0) {
+        *values1 = *values2 = array->ring;
+        *count1 = *count2 = 0;
+        return true;
+    }
+    _yy_array_split(array, range, &src1, &src2);
+    *values1 = array->ring + src1.location;
+    *count1 = src1.length;
+    *values2 = array->ring + src2.location;
+    *count2 = src2.length;
+    return true;
+}
+
+bool yy_array_get_stats(yy_array_t *array, yy_stats_t *stats) {
+    if (stats == NULL) return false;
+#ifdef YY_ENABLE_STATS
+    *stats = array->stats;
+    return true;
+#else
+    (void)array;
+    memset(stats, 0, sizeof(yy_stats_t));
+    return false;
+#endif
+}
+
+/**
+ * A parallel job over an array range cut in chunks.
+ */
+typedef struct _yy_array_parallel {
+    yy_array_t *array;
+    yy_range range;
+    long grain;
+    yy_array_foreach_func func;
+    yy_array_map_func map_func;
+    yy_array_combine_func combine_func;
+    void *identity;
+    void *context;
+    void **results;     ///< result of each chunk (reduce)
+    void *result;       ///< result of the running chunk (reduce, serial)
+} yy_array_parallel_t;
+
+yy_inline yy_range _yy_array_parallel_chunk(yy_array_parallel_t *job, long index) {
+    long location = job->range.location + index * job->grain;
+    return yy_range_make(location, YY_MIN(job->grain, job->range.location + job->range.length - location));
+}
+
+static void _yy_array_foreach_chunk(long index, void *context) {
+    yy_array_parallel_t *job = context;
+    yy_array_foreach_range(job->array, _yy_array_parallel_chunk(job, index), job->func, job->context);
+}
+
+static void _yy_array_reduce_value(long index, const void *value, void *context) {
+    yy_array_parallel_t *chunk = context;
+    chunk->result = chunk->combine_func(chunk->result, chunk->map_func(index, value, chunk->context), chunk->context);
+}
+
+static void _yy_array_reduce_chunk(long index, void *context) {
+    yy_array_parallel_t chunk = *(yy_array_parallel_t *)context;
+    
+    chunk.result = chunk.identity;
+    yy_array_foreach_range(chunk.array, _yy_array_parallel_chunk(&chunk, index), _yy_array_reduce_value, &chunk);
+    chunk.results[index] = chunk.result;
+}
+
+bool yy_array_foreach_parallel(yy_array_t *array, yy_range range, yy_array_foreach_func func, void *context, long grain) {
+    yy_array_parallel_t job;
+    
+    if (!func) return false;
+    if (!_yy_array_validate_range(array, range, __func__)) return false;
+    
+    memset(&job, 0, sizeof(job));
+    job.array = array;
+    job.range = range;
+    job.grain = grain > 0 ? grain : YY_ARRAY_PARALLEL_GRAIN;
+    job.func = func;
+    job.context = context;
+    yy_executor_parallel_for(yy_executor_get_default(), (range.length + job.grain - 1) / job.grain,
+                             _yy_array_foreach_chunk, &job);
+    return true;
+}
+
+void * yy_array_reduce_parallel(yy_array_t *array, yy_range range,
+                                yy_array_map_func map_func, yy_array_combine_func combine_func,
+                                void *identity, void *context, long grain) {
+    yy_array_parallel_t job;
+    long i, chunk_count;
+    void *result;
+    
+    if (!map_func || !combine_func) return identity;
+    if (!_yy_array_validate_range(array, range, __func__)) return identity;
+    if (range.length == 0) return identity;
+    
+    memset(&job, 0, sizeof(job));
+    job.array = array;
+    job.range = range;
+    job.grain = grain > 0 ? grain : YY_ARRAY_PARALLEL_GRAIN;
+    job.map_func = map_func;
+    job.combine_func = combine_func;
+    job.identity = identity;
+    job.context = context;
+    chunk_count = (range.length + job.grain - 1) / job.grain;
+    job.results = malloc(chunk_count * sizeof(void *));
+    if (job.results == NULL) {
+        yy_log_error("yy_array_t(%p):%s() attempt to allocate %ld bytes failed",
+                     array, __func__, chunk_count * sizeof(void *));
+        return identity;
+    }
+    yy_executor_parallel_for(yy_executor_get_default(), chunk_count, _yy_array_reduce_chunk, &job);
+    
+    result = job.results[0];
+    for (i = 1; i < chunk_count; i++) {
+        result = combine_func(result, job.results[i], context);
+    }
+    free(job.results);
+    return result;
+}
+
+bool yy_array_write_file(yy_array_t *array, const char *path) {
+    yy_file_header_t header;
+    uint64_t *offsets, blob_size;
+    const char *str;
+    FILE *fp;
+    long i;
+    bool ok;
+    
+    if (path == NULL) return false;
+    if (array->callback.equal != _yy_array_string_equal_callback) {
+        yy_log_error("yy_array_t(%p):%s() only arrays of strings (yy_array_string_callback) can be written",
+                     array, __func__);
+        return false;
+    }
+    offsets = malloc(YY_MAX(array->count, 1) * sizeof(uint64_t));
+    if (offsets == NULL) {
+        yy_log_error("yy_array_t(%p):%s() attempt to allocate %ld bytes failed",
+                     array, __func__, array->count * sizeof(uint64_t));
+        return false;
+    }
+    blob_size = 0;
+    for (i = 0; i < array->count; i++) {
+        str = yy_array_get(array, i);
+        if (str == NULL) {
+            yy_log_error("yy_array_t(%p):%s() value at index(%ld) is not a string",
+                         array, __func__, i);
+            free(offsets);
+            return false;
+        }
+        offsets[i] = blob_size;
+        blob_size += strlen(str) + 1;
+    }
+    
+    memset(&header, 0, sizeof(header));
+    header.magic = YY_FILE_ARRAY_MAGIC;
+    header.version = YY_FILE_VERSION;
+    header.count = array->count;
+    header.table_offset = _yy_file_align(sizeof(header));
+    header.blob_offset = header.table_offset + _yy_file_align(array->count * sizeof(uint64_t));
+    header.blob_size = blob_size;
+    
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        yy_log_error("yy_array_t(%p):%s() cannot open file(%s)",
+                     array, __func__, path);
+        free(offsets);
+        return false;
+    }
+    ok = _yy_file_write(fp, &header, sizeof(header))
+        && _yy_file_pad(fp, sizeof(header))
+        && _yy_file_write(fp, offsets, array->count * sizeof(uint64_t))
+        && _yy_file_pad(fp, array->count * sizeof(uint64_t));
+    for (i = 0; ok && i < array->count; i++) {
+        str = yy_array_get(array, i);
+        ok = _yy_file_write(fp, str, strlen(str) + 1);
+    }
+    ok = ok && _yy_file_pad(fp, blob_size);
+    ok = (fclose(fp) == 0) && ok;
+    free(offsets);
+    if (!ok) {
+        yy_log_error("yy_array_t(%p):%s() write file(%s) failed",
+                     array, __func__, path);
+    }
+    return ok;
+}
+
+yy_array_t * yy_array_create_with_file(const char *path) {
+    yy_file_view_t *view;
+    yy_array_t *array;
+    
+    view = _yy_file_view_open(path, YY_FILE_ARRAY_MAGIC);
+    if (view == NULL) return NULL;
+    array = yy_array_create_with_options(0, &yy_array_string_callback);
+    if (array == NULL) {
+        _yy_file_view_release(view);
+        return NULL;
+    }
+    array->view = view;
+    array->count = (long)view->header->count;
+    return array;
+}
@@ -16,10 +16,23 @@
 #include <stdint.h>
 
 #include "yy_base.h"
+#include "yy_stats.h"
 
 /// Prototype of a callback function that may be applied to every value in an array.
 typedef void (*yy_array_foreach_func)(long index, const void *value, void *context);
 
+/// Prototype of a predicate applied to the values of an array, return true to select the value.
+typedef bool (*yy_array_predicate_func)(long index, const void *value, void *context);
+
+/// Prototype of a function that maps a value to a partial result of yy_array_reduce_parallel().
+typedef void *(*yy_array_map_func)(long index, const void *value, void *context);
+
+/// Prototype of a function that combines two partial results of yy_array_reduce_parallel().
+typedef void *(*yy_array_combine_func)(void *result1, void *result2, void *context);
+
+/// Prototype of a callback function invoked with a value evicted from a bounded array (it receives the reference).
+typedef void (*yy_array_evict_func)(const void *value, void *context);
+
 /// Prototype of a callback function used to retain a value being added to an array.
 typedef void *(*yy_array_retain_callback)(const void *value);
 
@@ -59,6 +72,10 @@ extern yy_array_callback_t yy_array_object_callback;
  yy_array_append(array, (void*) 1);
  yy_array_append(array, (void*) 2);
  yy_release(array);
+ 
+ Small arrays keep their first values in the same allocation as the array
+ object, yy_array_create_with_values() allocates the object and all the
+ values in a single block.
  */
 typedef struct _yy_array   yy_array_t;
 
@@ -66,7 +83,9 @@ yy_array_t * yy_array_create();
 yy_array_t * yy_array_create_for_string();
 yy_array_t * yy_array_create_for_object();
 yy_array_t * yy_array_create_with_options(long capacity, const yy_array_callback_t *callback);
+/// Copy an array with its callback and gap mode, the values are shared until one of the arrays is modified.
 yy_array_t * yy_array_create_copy(yy_array_t *array);
+yy_array_t * yy_array_create_with_values(const void **values, long count, const yy_array_callback_t *callback);
 
 const void * yy_array_get(yy_array_t *array, long index);
 const void * yy_array_get_last(yy_array_t *array, long index);
@@ -88,4 +107,176 @@ bool yy_array_sort_range(yy_array_t *array, yy_range range, yy_comparator_func c
 bool yy_array_foreach(yy_array_t *array, yy_array_foreach_func func, void *context);
 bool yy_array_foreach_range(yy_array_t *array, yy_range range, yy_array_foreach_func func, void *context);
 
+/**
+ Inline access (no function call, the index is wrapped with a mask).
+ 
+ The `_unsafe` functions do not validate their arguments when YY_RELEASE is
+ defined: the index must be in bounds and the array must not be mapped from
+ a file. Without YY_RELEASE they fall back to the checked functions on error.
+ 
+ Example:
+ const void *value;
+ YY_ARRAY_FOREACH(array, i, value) {
+     printf("%ld: %p\n", i, value);
+ }
+ */
+typedef struct _yy_array_head {
+    long count;
+    long capacity;
+    long index;
+    const void **ring;
+    long gap;
+    const void *view;
+} yy_array_head_t;
+
+yy_inline long yy_array_count_unsafe(yy_array_t *array) {
+    return ((const yy_array_head_t *)array)->count;
+}
+
+yy_inline const void * yy_array_get_unsafe(yy_array_t *array, long index) {
+    const yy_array_head_t *head = (const yy_array_head_t *)array;
+#ifndef YY_RELEASE
+    if ((unsigned long)index >= (unsigned long)head->count || head->view) {
+        return yy_array_get(array, index);
+    }
+#endif
+    if (index >= head->gap) index += head->capacity - head->count;
+    return head->ring[(head->index + index) & (head->capacity - 1)];
+}
+
+yy_inline const void * yy_array_get_last_unsafe(yy_array_t *array, long index) {
+    return yy_array_get_unsafe(array, yy_array_count_unsafe(array) - index - 1);
+}
+
+/// Loop over the values of an array in order, `value` must be declared before.
+#define YY_ARRAY_FOREACH(array, i, value) \
+    for (long i = 0, i##_count = yy_array_count_unsafe(array); \
+         i < i##_count && ((value = yy_array_get_unsafe((array), i)), true); i++)
+
+/// Loop over the values of an array in reverse order, `value` must be declared before.
+#define YY_ARRAY_FOREACH_REVERSE(array, i, value) \
+    for (long i = yy_array_count_unsafe(array) - 1; \
+         i >= 0 && ((value = yy_array_get_unsafe((array), i)), true); i--)
+
+/**
+ Apply func to every value in range on all CPUs.
+ The range is cut in chunks of `grain` values (<= 0 for the default), a chunk
+ is walked in order by one thread. The array must not be modified meanwhile.
+ */
+bool yy_array_foreach_parallel(yy_array_t *array, yy_range range, yy_array_foreach_func func, void *context, long grain);
+
+/**
+ Map every value in range and combine the results on all CPUs.
+ 
+ Each chunk of `grain` values (<= 0 for the default) is folded from `identity`
+ in index order, then the chunk results are combined in chunk order, so the
+ result does not depend on the number of threads (combine_func should be
+ associative). Returns identity for an empty range.
+ */
+void * yy_array_reduce_parallel(yy_array_t *array, yy_range range,
+                                yy_array_map_func map_func, yy_array_combine_func combine_func,
+                                void *identity, void *context, long grain);
+
+/**
+ Remove the values in range for which predicate returns true, in one pass.
+ The predicate gets the original index of each value and must not modify the array.
+ */
+bool yy_array_remove_if(yy_array_t *array, yy_range range, yy_array_predicate_func predicate, void *context);
+
+/**
+ Remove the values at the indices, in one pass.
+ 
+ @param indices strictly ascending indices
+ @param count   number of indices
+ */
+bool yy_array_remove_indices(yy_array_t *array, const long *indices, long count);
+
+/**
+ Ownership transfer, to move values between containers without retain/release.
+ 
+ The `_transfer` functions adopt a reference the caller already owns: the
+ retain callback is not called (on failure the caller still owns it).
+ The take/pop functions remove values and hand their references to the
+ caller: the release callback is not called, the caller must release them.
+ 
+ Example (move a string between two string arrays, no strdup/free):
+ const void *value;
+ if (yy_array_pop_front(queue, &value)) yy_array_append_transfer(done, value);
+ */
+bool yy_array_append_transfer(yy_array_t *array, const void *value);
+bool yy_array_insert_transfer(yy_array_t *array, long index, const void *value);
+bool yy_array_take(yy_array_t *array, long index, const void **value);
+bool yy_array_take_range(yy_array_t *array, yy_range range, const void **values);
+/// Returns false if the array is empty.
+bool yy_array_pop_front(yy_array_t *array, const void **value);
+/// Returns false if the array is empty.
+bool yy_array_pop_back(yy_array_t *array, const void **value);
+
+/**
+ Gap buffer mode, for editing around a cursor.
+ 
+ The free slots of the ring are kept at the last edit position instead of
+ after the last value, so a run of inserts/removes at nearby indices costs
+ O(1) each. The gap is moved only when an edit jumps elsewhere (the values
+ in between are shifted) or when the ring grows. Reads are not affected.
+ Disabling the mode moves the gap back to the end.
+ */
+bool yy_array_set_gap_mode(yy_array_t *array, bool enabled);
+
+/**
+ Bounded array, for "last N values" windows.
+ 
+ The array never holds more than `bound` values and its ring is allocated
+ once with the array. Appending to a full array overwrites the oldest value
+ in O(1) (the ring start moves forward, no value is shifted), and any other
+ edit that would exceed the bound evicts values from the front. An evicted
+ value is handed to `evict` (which then owns the reference and must not
+ modify the array), or released with the callback if evict is NULL.
+ Copies keep the bound and the evict function.
+ 
+ Example:
+ yy_array_t *window = yy_array_create_bounded(100, NULL, NULL, NULL);
+ yy_array_append(window, sample); // drops the oldest of 100 samples
+ */
+yy_array_t * yy_array_create_bounded(long bound, const yy_array_callback_t *callback,
+                                     yy_array_evict_func evict, void *context);
+/// Returns the bound of the array, or 0 if it is not bounded.
+long yy_array_get_bound(yy_array_t *array);
+
+/**
+ Read a range in place, without copying: the values are ring segments
+ values1[0, count1) followed by values2[0, count2) (count2 is 0 if the range
+ does not wrap around the end of the ring). The pointers are valid until the
+ array is modified. A range spanning the gap of gap buffer mode moves the gap
+ out of the range first. Fails for arrays mapped from file.
+ 
+ Example (the whole window, oldest first):
+ const void * const *values1, * const *values2;
+ long count1, count2;
+ yy_array_get_window(window, yy_range_make(0, yy_array_count(window)),
+                     &values1, &count1, &values2, &count2);
+ */
+bool yy_array_get_window(yy_array_t *array, yy_range range,
+                         const void * const **values1, long *count1,
+                         const void * const **values2, long *count2);
+
+/**
+ Get the performance counters of the array (see yy_stats.h).
+ Returns false (and zeros) if the library was built without YY_ENABLE_STATS.
+ */
+bool yy_array_get_stats(yy_array_t *array, yy_stats_t *stats);
+
+/**
+ Write an array of C strings to a binary file.
+ Fails unless the array was created with yy_array_string_callback.
+ */
+bool yy_array_write_file(yy_array_t *array, const char *path);
+
+/**
+ Create a read-only string array from a file written by yy_array_write_file().
+ The file is mapped into memory and not parsed, the values point into the
+ mapping. Modifications fail, except yy_array_clear() which drops the mapping.
+ */
+yy_array_t * yy_array_create_with_file(const char *path);
+
 #endif
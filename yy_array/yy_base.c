@@ -32,10 +32,19 @@ void yy_release(void *object) {
 }
 
 void *_yy_alloc(size_t size, void *(*dealloc)(void *)) {
+    return _yy_alloc_named(size, dealloc, NULL);
+}
+
+void *_yy_alloc_named(size_t size, void *(*dealloc)(void *), const char *name) {
     yy_object *o = calloc(1, sizeof(yy_object) + size);
     if (o) {
         o->ref_count = 1;
         o->dealloc = dealloc;
+#ifdef YY_ENABLE_REGISTRY
+        _yy_registry_add(o, size, dealloc, name);
+#else
+        (void)name;
+#endif
         return o + 1;
     }
     return NULL;
@@ -44,6 +53,9 @@ void *_yy_alloc(size_t size, void *(*dealloc)(void *)) {
 void _yy_dealloc(void *object) {
     yy_object *o = object;
     o--;
+#ifdef YY_ENABLE_REGISTRY
+    _yy_registry_remove(o);
+#endif
     free(o);
 }
 
@@ -9,6 +9,9 @@
 #ifndef YYMidiBase_yy_base_private_h
 #define YYMidiBase_yy_base_private_h
 
+#include <stdint.h>
+#include "yy_base.h"
+
 #undef	YY_MAX
 #define YY_MAX(a, b)  (((a) > (b)) ? (a) : (b))
 
@@ -21,19 +24,66 @@
 #undef	YY_CLAMP
 #define YY_CLAMP(x, low, high)  (((x) > (high)) ? (high) : (((x) < (low)) ? (low) : (x)))
 
+#undef	YY_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define YY_PREFETCH(addr)  __builtin_prefetch(addr)
+#else
+#define YY_PREFETCH(addr)
+#endif
+
+/**
+ Mix the bits of a hash (MurmurHash3 64-bit finalizer), used by the hash
+ tables: they select slots with a mask, so the low bits must depend on the
+ whole key (the default pointer hash has its low bits always zero).
+ */
+yy_inline uint64_t _yy_hash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
 
 typedef struct _yy_object yy_object;
 
+#ifdef YY_ENABLE_REGISTRY
+/// Registry record of an object (see yy_registry.h).
+typedef struct _yy_object_registry {
+    yy_object *prev;
+    yy_object *next;
+    long bytes;
+    int type;
+    int frame_count;
+    void **frames;
+} yy_object_registry_t;
+#endif
+
 struct _yy_object {
+#ifdef YY_ENABLE_REGISTRY
+    yy_object_registry_t registry;
+#endif
     long ref_count;
     void *(*dealloc)(void *);
     /* object struct */
 };
 
 void *_yy_alloc(size_t size, void *(*dealloc)(void *));
+void *_yy_alloc_named(size_t size, void *(*dealloc)(void *), const char *name);
 void _yy_dealloc(void *object);
 
-#define yy_alloc(type, dealloc) _yy_alloc(sizeof(type),(void *(*)(void *))(dealloc))
+#define yy_alloc(type, dealloc) _yy_alloc_named(sizeof(type),(void *(*)(void *))(dealloc), #type)
+
+#ifdef YY_ENABLE_REGISTRY
+void _yy_registry_add(yy_object *o, size_t size, void *(*dealloc)(void *), const char *name);
+void _yy_registry_remove(yy_object *o);
+void _yy_registry_set_bytes(void *object, long bytes);
+/// Update the bytes held by an object (the expression is not evaluated without the registry).
+#define YY_REGISTRY_SET_BYTES(object, bytes) _yy_registry_set_bytes((object), (bytes))
+#else
+#define YY_REGISTRY_SET_BYTES(object, bytes) do { } while (0)
+#endif
 #define yy_dealloc(object) _yy_dealloc(object);
 
 
@@ -0,0 +1,287 @@
+//
+//  yy_cache.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_cache.h"
+#include "yy_map_private.h"
+#include "yy_base_private.h"
+#include "yy_log.h"
+
+#include <string.h>
+
+typedef struct _yy_cache_node yy_cache_node_t;
+
+/**
+ * A map node with the list links right after it (allocated by the map).
+ */
+struct _yy_cache_node {
+    yy_map_node_t map_node;
+    yy_cache_node_t *prev;
+    yy_cache_node_t *next;
+    long cost;
+    bool referenced;        ///< CLOCK only
+};
+
+struct _yy_cache {
+    yy_map_t *map;
+    yy_cache_node_t *head;  ///< LRU: most recently used (head->prev is the least), CLOCK: the hand
+    yy_cache_policy policy;
+    long count_limit;       ///< 0 = no limit
+    long cost_limit;        ///< 0 = no limit
+    long total_cost;
+    yy_cache_evict_func evict;
+    void *evict_context;
+    yy_cache_stats_t stats;
+};
+
+/**
+ * Link a node into the circular list, before the head (at the back).
+ */
+yy_inline void _yy_cache_link_back(yy_cache_t *cache, yy_cache_node_t *node) {
+    yy_cache_node_t *head = cache->head;
+    
+    if (head == NULL) {
+        node->prev = node->next = node;
+        cache->head = node;
+        return;
+    }
+    node->next = head;
+    node->prev = head->prev;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+yy_inline void _yy_cache_unlink(yy_cache_t *cache, yy_cache_node_t *node) {
+    if (node->next == node) {
+        cache->head = NULL;
+        return;
+    }
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    if (cache->head == node) cache->head = node->next;
+}
+
+/**
+ * Mark a node as used.
+ */
+yy_inline void _yy_cache_touch(yy_cache_t *cache, yy_cache_node_t *node) {
+    if (cache->policy == YY_CACHE_CLOCK) {
+        node->referenced = true;
+    } else if (cache->head != node) {
+        _yy_cache_unlink(cache, node);
+        _yy_cache_link_back(cache, node);
+        cache->head = node;
+    }
+}
+
+/**
+ * Unlink a node and remove it from the map (releases key and value).
+ */
+static void _yy_cache_remove_node(yy_cache_t *cache, yy_cache_node_t *node) {
+    _yy_cache_unlink(cache, node);
+    cache->total_cost -= node->cost;
+    _yy_map_remove_node(cache->map, &node->map_node);
+}
+
+/**
+ * The next entry to evict (the cache is not empty).
+ */
+static yy_cache_node_t * _yy_cache_victim(yy_cache_t *cache) {
+    if (cache->policy == YY_CACHE_LRU) return cache->head->prev;
+    
+    /* the hand gives a second chance to the referenced entries, ends in one turn */
+    while (cache->head->referenced) {
+        cache->head->referenced = false;
+        cache->head = cache->head->next;
+    }
+    return cache->head;
+}
+
+static void _yy_cache_evict_node(yy_cache_t *cache, yy_cache_node_t *node) {
+    if (cache->evict) cache->evict(node->map_node.key, node->map_node.value, cache->evict_context);
+    cache->stats.evictions++;
+    _yy_cache_remove_node(cache, node);
+}
+
+/**
+ * Evict entries until the cache fits its limits.
+ */
+static void _yy_cache_trim(yy_cache_t *cache) {
+    while (cache->head
+           && ((cache->count_limit > 0 && yy_map_count(cache->map) > cache->count_limit)
+               || (cache->cost_limit > 0 && cache->total_cost > cache->cost_limit))) {
+        _yy_cache_evict_node(cache, _yy_cache_victim(cache));
+    }
+}
+
+static void _yy_cache_dealloc(yy_cache_t *cache) {
+    yy_release(cache->map);
+    yy_dealloc(cache);
+}
+
+yy_cache_t *yy_cache_create(long count_limit) {
+    return yy_cache_create_with_options(count_limit, 0, YY_CACHE_LRU, NULL, NULL);
+}
+
+yy_cache_t *yy_cache_create_with_options(long count_limit, long cost_limit, yy_cache_policy policy,
+                                         const yy_map_key_callback_t *key_callback,
+                                         const yy_map_value_callback_t *value_callback) {
+    yy_cache_t *cache;
+    
+    if (count_limit < 0 || cost_limit < 0) {
+        yy_log_error("%s() limits(%ld,%ld) cannot be less than zero", __func__, count_limit, cost_limit);
+        return NULL;
+    }
+    if (policy != YY_CACHE_LRU && policy != YY_CACHE_CLOCK) {
+        yy_log_error("%s() unknown policy(%d)", __func__, (int)policy);
+        return NULL;
+    }
+    cache = yy_alloc(yy_cache_t, _yy_cache_dealloc);
+    if (cache == NULL) {
+        yy_log_error("yy_cache_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_cache_t));
+        return NULL;
+    }
+    cache->map = _yy_map_create_with_node_size(0, key_callback, value_callback, sizeof(yy_cache_node_t));
+    if (cache->map == NULL) {
+        yy_dealloc(cache);
+        return NULL;
+    }
+    cache->policy = policy;
+    cache->count_limit = count_limit;
+    cache->cost_limit = cost_limit;
+    YY_REGISTRY_SET_BYTES(cache, sizeof(yy_cache_t));
+    return cache;
+}
+
+long yy_cache_count(yy_cache_t *cache) {
+    return yy_map_count(cache->map);
+}
+
+long yy_cache_get_cost(yy_cache_t *cache) {
+    return cache->total_cost;
+}
+
+yy_cache_policy yy_cache_get_policy(yy_cache_t *cache) {
+    return cache->policy;
+}
+
+bool yy_cache_set_limits(yy_cache_t *cache, long count_limit, long cost_limit) {
+    if (count_limit < 0 || cost_limit < 0) {
+        yy_log_error("yy_cache_t(%p):%s() limits(%ld,%ld) cannot be less than zero",
+                     cache, __func__, count_limit, cost_limit);
+        return false;
+    }
+    cache->count_limit = count_limit;
+    cache->cost_limit = cost_limit;
+    _yy_cache_trim(cache);
+    return true;
+}
+
+bool yy_cache_set_evict_func(yy_cache_t *cache, yy_cache_evict_func func, void *context) {
+    cache->evict = func;
+    cache->evict_context = context;
+    return true;
+}
+
+const void *yy_cache_get(yy_cache_t *cache, const void *key) {
+    yy_cache_node_t *node;
+    
+    node = (yy_cache_node_t *)_yy_map_find_node(cache->map, key);
+    if (node == NULL) {
+        cache->stats.misses++;
+        return NULL;
+    }
+    cache->stats.hits++;
+    _yy_cache_touch(cache, node);
+    return node->map_node.value;
+}
+
+const void *yy_cache_peek(yy_cache_t *cache, const void *key) {
+    yy_map_node_t *node;
+    
+    node = _yy_map_find_node(cache->map, key);
+    return node ? node->value : NULL;
+}
+
+bool yy_cache_contains_key(yy_cache_t *cache, const void *key) {
+    return _yy_map_find_node(cache->map, key) != NULL;
+}
+
+bool yy_cache_set(yy_cache_t *cache, const void *key, const void *value) {
+    return yy_cache_set_with_cost(cache, key, value, 0);
+}
+
+bool yy_cache_set_with_cost(yy_cache_t *cache, const void *key, const void *value, long cost) {
+    yy_cache_node_t *node;
+    bool added;
+    
+    if (cost < 0) {
+        yy_log_error("yy_cache_t(%p):%s() cost(%ld) cannot be less than zero",
+                     cache, __func__, cost);
+        return false;
+    }
+    node = (yy_cache_node_t *)_yy_map_set_node(cache->map, key, value, &added);
+    if (node == NULL) {
+        return false;
+    }
+    cache->total_cost += cost - node->cost;
+    node->cost = cost;
+    if (added) {
+        /* LRU: to the front, CLOCK: behind the hand (visited last) */
+        _yy_cache_link_back(cache, node);
+        if (cache->policy == YY_CACHE_LRU) cache->head = node;
+    } else {
+        _yy_cache_touch(cache, node);
+    }
+    if (cache->cost_limit > 0 && cost > cache->cost_limit) {
+        /* would flush the whole cache before its own turn */
+        _yy_cache_evict_node(cache, node);
+    }
+    _yy_cache_trim(cache);
+    return true;
+}
+
+bool yy_cache_remove(yy_cache_t *cache, const void *key) {
+    yy_cache_node_t *node;
+    
+    node = (yy_cache_node_t *)_yy_map_find_node(cache->map, key);
+    if (node == NULL) {
+        return false;
+    }
+    _yy_cache_remove_node(cache, node);
+    return true;
+}
+
+bool yy_cache_clear(yy_cache_t *cache) {
+    cache->head = NULL;
+    cache->total_cost = 0;
+    return yy_map_clear(cache->map);
+}
+
+bool yy_cache_foreach(yy_cache_t *cache, yy_map_foreach_func func, void *context) {
+    yy_cache_node_t *node;
+    
+    if (func == NULL) return false;
+    node = cache->head;
+    if (node == NULL) return true;
+    do {
+        func(node->map_node.key, node->map_node.value, context);
+        node = node->next;
+    } while (node != cache->head);
+    return true;
+}
+
+bool yy_cache_get_stats(yy_cache_t *cache, yy_cache_stats_t *stats) {
+    if (stats == NULL) return false;
+    *stats = cache->stats;
+    return true;
+}
+
+void yy_cache_reset_stats(yy_cache_t *cache) {
+    memset(&cache->stats, 0, sizeof(yy_cache_stats_t));
+}
@@ -0,0 +1,98 @@
+//
+//  yy_cache.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_cache_h
+#define YYMidiBase_yy_cache_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yy_base.h"
+#include "yy_map.h"
+
+/// Replacement policy of a cache.
+typedef enum {
+    YY_CACHE_LRU = 0,   ///< evict the least recently used entry, a hit moves the entry to the front
+    YY_CACHE_CLOCK      ///< second chance (approximate LRU), a hit only sets a flag
+} yy_cache_policy;
+
+/// Prototype of a callback function invoked for every entry evicted by the limits, before the key and value are released.
+typedef void (*yy_cache_evict_func)(const void *key, const void *value, void *context);
+
+/// Counters of a cache.
+typedef struct _yy_cache_stats {
+    unsigned long hits;         ///< yy_cache_get() calls that found the key
+    unsigned long misses;       ///< yy_cache_get() calls that did not
+    unsigned long evictions;    ///< entries evicted by the count and cost limits
+} yy_cache_stats_t;
+
+/**
+ YY Cache  (bounded key-value cache)
+ 
+ A yy_map (same key/value callbacks) whose nodes are also linked in a
+ doubly linked list, so every operation is O(1). When the count limit or
+ the cost limit (0 = no limit) is exceeded, entries are evicted:
+ 
+ LRU:   the list is kept in recency order, a hit moves the entry to the front
+        and the entry at the back is evicted.
+ CLOCK: the list is a ring swept by a hand, a hit only sets the entry's
+        referenced flag (no list writes). The hand clears the flags it
+        passes and evicts the first entry without one.
+ 
+ The cost of an entry is given by the caller (e.g. the bytes of the value),
+ entries set without a cost cost 0. An entry costlier than the cost limit
+ is evicted as soon as it is set. Evicted entries are handed to the evict
+ function, which must not modify the cache. Removed, replaced and cleared
+ entries are not evictions. Not thread safe.
+ 
+ Example:
+ yy_cache_t *cache = yy_cache_create_with_options(1000, 0, YY_CACHE_LRU,
+                                                  &yy_map_string_key_callback, &yy_map_object_value_callback);
+ yy_cache_set(cache, "piano.sf2", sound_font);
+ sound_font = yy_cache_get(cache, "piano.sf2");
+ yy_release(cache);
+ */
+typedef struct _yy_cache yy_cache_t;
+
+/// Create an LRU cache of at most count_limit pointer keys and values.
+yy_cache_t *yy_cache_create(long count_limit);
+yy_cache_t *yy_cache_create_with_options(long count_limit, long cost_limit, yy_cache_policy policy,
+                                         const yy_map_key_callback_t *key_callback,
+                                         const yy_map_value_callback_t *value_callback);
+
+long yy_cache_count(yy_cache_t *cache);
+/// The sum of the costs of the entries.
+long yy_cache_get_cost(yy_cache_t *cache);
+yy_cache_policy yy_cache_get_policy(yy_cache_t *cache);
+
+/// Change the limits (0 = no limit), entries are evicted right away to fit.
+bool yy_cache_set_limits(yy_cache_t *cache, long count_limit, long cost_limit);
+bool yy_cache_set_evict_func(yy_cache_t *cache, yy_cache_evict_func func, void *context);
+
+/// Returns the value of key (NULL if not found) and marks the entry as used. Counts a hit or a miss.
+const void *yy_cache_get(yy_cache_t *cache, const void *key);
+/// Returns the value of key (NULL if not found), without marking the entry or counting.
+const void *yy_cache_peek(yy_cache_t *cache, const void *key);
+bool yy_cache_contains_key(yy_cache_t *cache, const void *key);
+
+/// Set a key-value pair with cost 0, the entry is marked as used.
+bool yy_cache_set(yy_cache_t *cache, const void *key, const void *value);
+/// Set a key-value pair, the cost replaces the cost of an entry already present.
+bool yy_cache_set_with_cost(yy_cache_t *cache, const void *key, const void *value, long cost);
+bool yy_cache_remove(yy_cache_t *cache, const void *key);
+bool yy_cache_clear(yy_cache_t *cache);
+
+/// Apply func to every entry, from the most to the least recently used (LRU), or from the hand (CLOCK).
+bool yy_cache_foreach(yy_cache_t *cache, yy_map_foreach_func func, void *context);
+
+bool yy_cache_get_stats(yy_cache_t *cache, yy_cache_stats_t *stats);
+void yy_cache_reset_stats(yy_cache_t *cache);
+
+#endif
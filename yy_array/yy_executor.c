@@ -0,0 +1,580 @@
+//
+//  yy_executor.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "yy_executor.h"
+#include "yy_base_private.h"
+#include "yy_log.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#include <mach/thread_policy.h>
+#endif
+
+#define YY_EXECUTOR_MAX_THREADS 256
+#define YY_DEQUE_MIN_CAPACITY 64
+
+typedef struct _yy_task {
+    yy_task_func func;
+    void *context;
+    yy_task_group_t *group;
+    struct _yy_task *next;      ///< link in the shared queue
+} yy_task_t;
+
+typedef struct _yy_deque_buffer {
+    long capacity;              ///< power of 2
+    struct _yy_deque_buffer *retired; ///< smaller buffer replaced by this one
+    yy_task_t *slots[1];
+} yy_deque_buffer_t;
+
+/**
+ * Chase-Lev work stealing deque: the owner pushes and takes at the bottom,
+ * the others steal at the top. Old buffers are kept until the deque is
+ * destroyed because a thief may still read them.
+ */
+typedef struct _yy_deque {
+    long top;
+    long bottom;
+    yy_deque_buffer_t *buffer;
+} yy_deque_t;
+
+typedef struct _yy_worker {
+    yy_executor_t *executor;
+    pthread_t thread;
+    long index;
+    unsigned long seed;         ///< for picking a victim
+    yy_deque_t deque;
+} yy_worker_t;
+
+struct _yy_executor {
+    long thread_count;
+    bool bind_cpu;
+    yy_worker_t *workers;
+    pthread_mutex_t lock;       ///< guards the shared queue, sleeping and stop
+    pthread_cond_t wake;
+    yy_task_t *head;            ///< shared queue
+    yy_task_t *tail;
+    long queued;                ///< atomic, tasks not taken yet
+    long unfinished;            ///< atomic, tasks not done yet
+    long sleeping;
+    bool stop;
+};
+
+struct _yy_task_group {
+    yy_executor_t *executor;
+    pthread_mutex_t lock;       ///< guards pending
+    pthread_cond_t done;
+    long pending;
+};
+
+static __thread yy_worker_t *_yy_executor_current_worker;
+
+static pthread_once_t _yy_executor_default_once = PTHREAD_ONCE_INIT;
+static yy_executor_t *_yy_executor_default;
+
+
+/******************************* deque ****************************************/
+
+static bool _yy_deque_init(yy_deque_t *deque) {
+    deque->top = 0;
+    deque->bottom = 0;
+    deque->buffer = malloc(sizeof(yy_deque_buffer_t) + (YY_DEQUE_MIN_CAPACITY - 1) * sizeof(yy_task_t *));
+    if (deque->buffer == NULL) return false;
+    deque->buffer->capacity = YY_DEQUE_MIN_CAPACITY;
+    deque->buffer->retired = NULL;
+    return true;
+}
+
+static void _yy_deque_destroy(yy_deque_t *deque) {
+    yy_deque_buffer_t *buffer, *retired;
+    
+    for (buffer = deque->buffer; buffer; buffer = retired) {
+        retired = buffer->retired;
+        free(buffer);
+    }
+    deque->buffer = NULL;
+}
+
+static yy_deque_buffer_t * _yy_deque_grow(yy_deque_t *deque, yy_deque_buffer_t *buffer, long top, long bottom) {
+    yy_deque_buffer_t *new_buffer;
+    long i, capacity;
+    
+    capacity = buffer->capacity * 2;
+    new_buffer = malloc(sizeof(yy_deque_buffer_t) + (capacity - 1) * sizeof(yy_task_t *));
+    if (new_buffer == NULL) return NULL;
+    new_buffer->capacity = capacity;
+    new_buffer->retired = buffer;
+    for (i = top; i < bottom; i++) {
+        new_buffer->slots[i & (capacity - 1)] = __atomic_load_n(&buffer->slots[i & (buffer->capacity - 1)], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&deque->buffer, new_buffer, __ATOMIC_RELEASE);
+    return new_buffer;
+}
+
+/**
+ * Owner only.
+ */
+static bool _yy_deque_push(yy_deque_t *deque, yy_task_t *task) {
+    yy_deque_buffer_t *buffer;
+    long top, bottom;
+    
+    bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    buffer = __atomic_load_n(&deque->buffer, __ATOMIC_RELAXED);
+    if (bottom - top > buffer->capacity - 1) {
+        buffer = _yy_deque_grow(deque, buffer, top, bottom);
+        if (buffer == NULL) return false;
+    }
+    __atomic_store_n(&buffer->slots[bottom & (buffer->capacity - 1)], task, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Owner only, takes the newest task.
+ */
+static yy_task_t * _yy_deque_take(yy_deque_t *deque) {
+    yy_deque_buffer_t *buffer;
+    yy_task_t *task;
+    long top, bottom;
+    
+    bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    buffer = __atomic_load_n(&deque->buffer, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+    
+    if (top > bottom) {
+        /* empty */
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    task = __atomic_load_n(&buffer->slots[bottom & (buffer->capacity - 1)], __ATOMIC_RELAXED);
+    if (top == bottom) {
+        /* the last task, race with the thieves */
+        if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            task = NULL;
+        }
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return task;
+}
+
+/**
+ * Any thread, takes the oldest task. May fail spuriously when racing.
+ */
+static yy_task_t * _yy_deque_steal(yy_deque_t *deque) {
+    yy_deque_buffer_t *buffer;
+    yy_task_t *task;
+    long top, bottom;
+    
+    top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+    if (top >= bottom) return NULL;
+    
+    buffer = __atomic_load_n(&deque->buffer, __ATOMIC_ACQUIRE);
+    task = __atomic_load_n(&buffer->slots[top & (buffer->capacity - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+    return task;
+}
+
+
+/******************************* executor *************************************/
+
+static void _yy_executor_bind_cpu(long index) {
+#if defined(__APPLE__)
+    thread_affinity_policy_data_t policy;
+    policy.affinity_tag = (integer_t)index + 1;
+    thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_AFFINITY_POLICY,
+                      (thread_policy_t)&policy, THREAD_AFFINITY_POLICY_COUNT);
+#elif defined(__linux__)
+    cpu_set_t set;
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    CPU_ZERO(&set);
+    CPU_SET(index % YY_MAX(cpu_count, 1), &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        yy_log_error("%s() bind worker(%ld) failed", __func__, index);
+    }
+#endif
+}
+
+static yy_task_t * _yy_executor_pop_shared(yy_executor_t *executor) {
+    yy_task_t *task;
+    
+    if (__atomic_load_n(&executor->head, __ATOMIC_RELAXED) == NULL) return NULL;
+    pthread_mutex_lock(&executor->lock);
+    task = executor->head;
+    if (task) {
+        __atomic_store_n(&executor->head, task->next, __ATOMIC_RELAXED);
+        if (task->next == NULL) executor->tail = NULL;
+    }
+    pthread_mutex_unlock(&executor->lock);
+    return task;
+}
+
+/**
+ * Find a task: own deque first, then the shared queue, then steal.
+ *
+ * @param worker current worker of the executor or NULL
+ */
+static yy_task_t * _yy_executor_find_task(yy_executor_t *executor, yy_worker_t *worker) {
+    yy_worker_t *victim;
+    yy_task_t *task = NULL;
+    long i, start;
+    
+    if (worker) task = _yy_deque_take(&worker->deque);
+    if (task == NULL) task = _yy_executor_pop_shared(executor);
+    if (task == NULL) {
+        if (worker) {
+            worker->seed = worker->seed * 6364136223846793005UL + 1442695040888963407UL;
+            start = (long)((worker->seed >> 33) % executor->thread_count);
+        } else {
+            start = 0;
+        }
+        for (i = 0; i < executor->thread_count && task == NULL; i++) {
+            victim = executor->workers + (start + i) % executor->thread_count;
+            if (victim != worker) task = _yy_deque_steal(&victim->deque);
+        }
+    }
+    if (task) __atomic_fetch_sub(&executor->queued, 1, __ATOMIC_SEQ_CST);
+    return task;
+}
+
+static void _yy_task_group_leave(yy_task_group_t *group) {
+    pthread_mutex_lock(&group->lock);
+    if (--group->pending == 0) pthread_cond_broadcast(&group->done);
+    pthread_mutex_unlock(&group->lock);
+}
+
+static void _yy_executor_run(yy_executor_t *executor, yy_task_t *task) {
+    task->func(task->context);
+    if (task->group) _yy_task_group_leave(task->group);
+    free(task);
+    
+    if (__atomic_sub_fetch(&executor->unfinished, 1, __ATOMIC_SEQ_CST) == 0
+        && __atomic_load_n(&executor->stop, __ATOMIC_SEQ_CST)) {
+        /* the workers waiting to exit */
+        pthread_mutex_lock(&executor->lock);
+        pthread_cond_broadcast(&executor->wake);
+        pthread_mutex_unlock(&executor->lock);
+    }
+}
+
+static void * _yy_executor_worker(void *arg) {
+    yy_worker_t *worker = arg;
+    yy_executor_t *executor = worker->executor;
+    yy_task_t *task;
+    bool exit;
+    
+    _yy_executor_current_worker = worker;
+    if (executor->bind_cpu) _yy_executor_bind_cpu(worker->index);
+    
+    for (;;) {
+        task = _yy_executor_find_task(executor, worker);
+        if (task) {
+            _yy_executor_run(executor, task);
+            continue;
+        }
+        
+        pthread_mutex_lock(&executor->lock);
+        __atomic_fetch_add(&executor->sleeping, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&executor->queued, __ATOMIC_SEQ_CST) <= 0
+               && !(executor->stop && __atomic_load_n(&executor->unfinished, __ATOMIC_SEQ_CST) == 0)) {
+            pthread_cond_wait(&executor->wake, &executor->lock);
+        }
+        __atomic_fetch_sub(&executor->sleeping, 1, __ATOMIC_SEQ_CST);
+        exit = executor->stop && __atomic_load_n(&executor->unfinished, __ATOMIC_SEQ_CST) == 0;
+        pthread_mutex_unlock(&executor->lock);
+        if (exit) break;
+    }
+    _yy_executor_current_worker = NULL;
+    return NULL;
+}
+
+static bool _yy_executor_push(yy_executor_t *executor, yy_task_func func, void *context, yy_task_group_t *group) {
+    yy_worker_t *worker;
+    yy_task_t *task;
+    
+    task = malloc(sizeof(yy_task_t));
+    if (task == NULL) {
+        yy_log_error("yy_executor_t(%p):%s() attempt to allocate %ld bytes failed",
+                     executor, __func__, sizeof(yy_task_t));
+        return false;
+    }
+    task->func = func;
+    task->context = context;
+    task->group = group;
+    task->next = NULL;
+    
+    __atomic_fetch_add(&executor->unfinished, 1, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&executor->queued, 1, __ATOMIC_SEQ_CST);
+    worker = _yy_executor_current_worker;
+    if (worker == NULL || worker->executor != executor || !_yy_deque_push(&worker->deque, task)) {
+        pthread_mutex_lock(&executor->lock);
+        if (executor->tail) executor->tail->next = task;
+        else __atomic_store_n(&executor->head, task, __ATOMIC_RELAXED);
+        executor->tail = task;
+        pthread_mutex_unlock(&executor->lock);
+    }
+    
+    if (__atomic_load_n(&executor->sleeping, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&executor->lock);
+        pthread_cond_signal(&executor->wake);
+        pthread_mutex_unlock(&executor->lock);
+    }
+    return true;
+}
+
+static void _yy_executor_dealloc(yy_executor_t *executor) {
+    long i;
+    
+    if (_yy_executor_current_worker && _yy_executor_current_worker->executor == executor) {
+        /* a worker cannot join itself, leak the executor */
+        yy_log_error("yy_executor_t(%p):%s() released from one of its tasks",
+                     executor, __func__);
+        pthread_mutex_lock(&executor->lock);
+        __atomic_store_n(&executor->stop, true, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&executor->lock);
+        return;
+    }
+    
+    pthread_mutex_lock(&executor->lock);
+    __atomic_store_n(&executor->stop, true, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&executor->wake);
+    pthread_mutex_unlock(&executor->lock);
+    for (i = 0; i < executor->thread_count; i++) {
+        pthread_join(executor->workers[i].thread, NULL);
+    }
+    for (i = 0; i < executor->thread_count; i++) {
+        _yy_deque_destroy(&executor->workers[i].deque);
+    }
+    free(executor->workers);
+    pthread_cond_destroy(&executor->wake);
+    pthread_mutex_destroy(&executor->lock);
+    yy_dealloc(executor);
+}
+
+yy_executor_t * yy_executor_create(long thread_count) {
+    yy_executor_options_t options;
+    
+    memset(&options, 0, sizeof(options));
+    options.thread_count = thread_count;
+    return yy_executor_create_with_options(&options);
+}
+
+yy_executor_t * yy_executor_create_with_options(const yy_executor_options_t *options) {
+    yy_executor_t *executor;
+    long i, j, thread_count;
+    
+    thread_count = options ? options->thread_count : 0;
+    if (thread_count < 0 || thread_count > YY_EXECUTOR_MAX_THREADS) {
+        yy_log_error("%s() thread_count(%ld) out of bounds(0,%d)",
+                     __func__, thread_count, YY_EXECUTOR_MAX_THREADS);
+        return NULL;
+    }
+    if (thread_count == 0) {
+        thread_count = YY_CLAMP(sysconf(_SC_NPROCESSORS_ONLN), 1, YY_EXECUTOR_MAX_THREADS);
+    }
+    
+    executor = yy_alloc(yy_executor_t, _yy_executor_dealloc);
+    if (executor == NULL) {
+        yy_log_error("yy_executor_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_executor_t));
+        return NULL;
+    }
+    executor->workers = calloc(thread_count, sizeof(yy_worker_t));
+    if (executor->workers == NULL) {
+        yy_log_error("yy_executor_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, thread_count * sizeof(yy_worker_t));
+        yy_dealloc(executor);
+        return NULL;
+    }
+    executor->bind_cpu = options ? options->bind_cpu : false;
+    pthread_mutex_init(&executor->lock, NULL);
+    pthread_cond_init(&executor->wake, NULL);
+    
+    for (i = 0; i < thread_count; i++) {
+        executor->workers[i].executor = executor;
+        executor->workers[i].index = i;
+        executor->workers[i].seed = (unsigned long)i * 0x9E3779B97F4A7C15UL + 1;
+        if (!_yy_deque_init(&executor->workers[i].deque)) break;
+    }
+    executor->thread_count = i;
+    for (i = 0; i < executor->thread_count; i++) {
+        if (pthread_create(&executor->workers[i].thread, NULL, _yy_executor_worker, executor->workers + i) != 0) {
+            for (j = i; j < executor->thread_count; j++) {
+                _yy_deque_destroy(&executor->workers[j].deque);
+            }
+            executor->thread_count = i;
+        }
+    }
+    if (executor->thread_count < thread_count) {
+        yy_log_error("yy_executor_t:%s() only %ld of %ld workers started",
+                     __func__, executor->thread_count, thread_count);
+        if (executor->thread_count == 0) {
+            yy_release(executor);
+            return NULL;
+        }
+    }
+    return executor;
+}
+
+static void _yy_executor_default_init() {
+    long thread_count = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    _yy_executor_default = yy_executor_create(YY_CLAMP(thread_count, 1, YY_EXECUTOR_MAX_THREADS));
+}
+
+yy_executor_t * yy_executor_get_default() {
+    pthread_once(&_yy_executor_default_once, _yy_executor_default_init);
+    return _yy_executor_default;
+}
+
+long yy_executor_thread_count(yy_executor_t *executor) {
+    return executor->thread_count;
+}
+
+bool yy_executor_submit(yy_executor_t *executor, yy_task_func func, void *context) {
+    if (!func) return false;
+    return _yy_executor_push(executor, func, context, NULL);
+}
+
+
+/******************************* parallel for *********************************/
+
+typedef struct _yy_executor_for {
+    yy_executor_for_func func;
+    void *context;
+    long count;
+    long next;      ///< atomic, next index to run
+} yy_executor_for_t;
+
+static void _yy_executor_for_drain(void *context) {
+    yy_executor_for_t *job = context;
+    long index;
+    
+    while ((index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->count) {
+        job->func(index, job->context);
+    }
+}
+
+bool yy_executor_parallel_for(yy_executor_t *executor, long count, yy_executor_for_func func, void *context) {
+    yy_task_group_t *group;
+    yy_executor_for_t job;
+    long i, helpers;
+    
+    if (!func) return false;
+    if (count <= 0) return true;
+    
+    job.func = func;
+    job.context = context;
+    job.count = count;
+    job.next = 0;
+    helpers = executor ? YY_MIN(count - 1, executor->thread_count) : 0;
+    if (_yy_executor_current_worker && _yy_executor_current_worker->executor == executor) {
+        /* the calling worker is one of them */
+        helpers = YY_MIN(helpers, executor->thread_count - 1);
+    }
+    group = helpers > 0 ? yy_task_group_create(executor) : NULL;
+    if (group) {
+        for (i = 0; i < helpers; i++) {
+            if (!yy_task_group_submit(group, _yy_executor_for_drain, &job)) break;
+        }
+    }
+    _yy_executor_for_drain(&job);
+    if (group) {
+        yy_task_group_wait(group);
+        yy_release(group);
+    }
+    return true;
+}
+
+
+/******************************* task group ***********************************/
+
+static void _yy_task_group_dealloc(yy_task_group_t *group) {
+    yy_task_group_wait(group);
+    pthread_cond_destroy(&group->done);
+    pthread_mutex_destroy(&group->lock);
+    yy_dealloc(group);
+}
+
+yy_task_group_t * yy_task_group_create(yy_executor_t *executor) {
+    yy_task_group_t *group;
+    
+    if (executor == NULL) {
+        yy_log_error("%s() executor cannot be null",
+                     __func__);
+        return NULL;
+    }
+    group = yy_alloc(yy_task_group_t, _yy_task_group_dealloc);
+    if (group == NULL) {
+        yy_log_error("yy_task_group_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_task_group_t));
+        return NULL;
+    }
+    group->executor = executor;
+    pthread_mutex_init(&group->lock, NULL);
+    pthread_cond_init(&group->done, NULL);
+    return group;
+}
+
+bool yy_task_group_submit(yy_task_group_t *group, yy_task_func func, void *context) {
+    if (!func) return false;
+    pthread_mutex_lock(&group->lock);
+    group->pending++;
+    pthread_mutex_unlock(&group->lock);
+    if (!_yy_executor_push(group->executor, func, context, group)) {
+        _yy_task_group_leave(group);
+        return false;
+    }
+    return true;
+}
+
+void yy_task_group_wait(yy_task_group_t *group) {
+    yy_executor_t *executor = group->executor;
+    yy_worker_t *worker;
+    yy_task_t *task;
+    long pending;
+    
+    worker = _yy_executor_current_worker;
+    if (worker && worker->executor != executor) worker = NULL;
+    
+    for (;;) {
+        pthread_mutex_lock(&group->lock);
+        pending = group->pending;
+        pthread_mutex_unlock(&group->lock);
+        if (pending == 0) return;
+        
+        /* help while the tasks of the group are queued */
+        task = _yy_executor_find_task(executor, worker);
+        if (task) {
+            _yy_executor_run(executor, task);
+            continue;
+        }
+        
+        /* the remaining tasks are running on other threads */
+        pthread_mutex_lock(&group->lock);
+        while (group->pending > 0) {
+            pthread_cond_wait(&group->done, &group->lock);
+        }
+        pthread_mutex_unlock(&group->lock);
+        return;
+    }
+}
@@ -0,0 +1,86 @@
+//
+//  yy_executor.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_executor_h
+#define YYMidiBase_yy_executor_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yy_base.h"
+
+/// Prototype of a task run by an executor.
+typedef void (*yy_task_func)(void *context);
+
+/// Prototype of a function called by yy_executor_parallel_for(), index is in [0, count).
+typedef void (*yy_executor_for_func)(long index, void *context);
+
+
+typedef struct _yy_executor_options {
+    long thread_count;  ///< number of worker threads, 0 for one per CPU
+    bool bind_cpu;      ///< bind worker i to CPU i (an affinity hint on OS X)
+} yy_executor_options_t;
+
+
+/**
+ YY Executor  (fixed pool of worker threads with work stealing)
+ 
+ Every worker has its own deque (Chase-Lev): tasks submitted from a worker
+ are pushed to its deque and popped in LIFO order, idle workers steal the
+ oldest tasks of the others. Tasks submitted from other threads go through
+ a shared queue.
+ 
+ Example:
+ 
+ yy_task_group_t *group = yy_task_group_create(yy_executor_get_default());
+ yy_task_group_submit(group, load_track, track1);
+ yy_task_group_submit(group, load_track, track2);
+ yy_task_group_wait(group);
+ yy_release(group);
+ 
+ An executor must not be released from one of its own tasks, and must
+ outlive its task groups. The queued tasks are run before the workers exit.
+ */
+typedef struct _yy_executor yy_executor_t;
+
+yy_executor_t * yy_executor_create(long thread_count);
+yy_executor_t * yy_executor_create_with_options(const yy_executor_options_t *options);
+
+/// The executor shared by the library (one worker per CPU but one), do not release it.
+yy_executor_t * yy_executor_get_default();
+
+long yy_executor_thread_count(yy_executor_t *executor);
+
+/// Run func(context) on the executor, without waiting for it.
+bool yy_executor_submit(yy_executor_t *executor, yy_task_func func, void *context);
+
+/**
+ Call func for every index in [0, count) on the executor and wait.
+ The calling thread runs indices too, which are handed out one by one,
+ so an index should be a chunk of work rather than a single element.
+ */
+bool yy_executor_parallel_for(yy_executor_t *executor, long count, yy_executor_for_func func, void *context);
+
+
+
+/**
+ YY Task Group  (fork/join)
+ 
+ Tasks submitted to a group can be waited for together, a task may submit
+ more tasks to its group. The waiting thread runs queued tasks meanwhile.
+ Releasing a group waits for its tasks.
+ */
+typedef struct _yy_task_group yy_task_group_t;
+
+yy_task_group_t * yy_task_group_create(yy_executor_t *executor);
+bool yy_task_group_submit(yy_task_group_t *group, yy_task_func func, void *context);
+void yy_task_group_wait(yy_task_group_t *group);
+
+#endif
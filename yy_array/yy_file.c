@@ -0,0 +1,151 @@
+//
+//  yy_file.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_file_private.h"
+#include "yy_base.h"
+#include "yy_log.h"
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Check that a section lies inside the file.
+ */
+static bool _yy_file_view_check(yy_file_view_t *view, uint64_t offset, uint64_t count, uint64_t size) {
+    if (offset > view->size) return false;
+    if (size && count > (view->size - offset) / size) return false;
+    return true;
+}
+
+/**
+ * Check that a string offset lies inside the blob (the blob ends with a NUL,
+ * so every string in it is terminated).
+ */
+yy_inline bool _yy_file_view_check_string(yy_file_view_t *view, uint64_t offset) {
+    return offset < view->header->blob_size;
+}
+
+/**
+ * Check the string offsets and the slots, the per-entry data used without
+ * bounds checks afterwards.
+ */
+static bool _yy_file_view_check_table(yy_file_view_t *view, uint32_t magic) {
+    const yy_file_map_entry_t *entries;
+    const uint64_t *offsets;
+    uint64_t i, count;
+    bool empty;
+    
+    count = view->header->count;
+    if (magic == YY_FILE_ARRAY_MAGIC) {
+        offsets = view->table;
+        for (i = 0; i < count; i++) {
+            if (!_yy_file_view_check_string(view, offsets[i])) return false;
+        }
+        return true;
+    }
+    
+    entries = view->table;
+    for (i = 0; i < count; i++) {
+        if (!_yy_file_view_check_string(view, entries[i].key)) return false;
+        if (entries[i].value != YY_FILE_NULL_OFFSET
+            && !_yy_file_view_check_string(view, entries[i].value)) return false;
+    }
+    /* a probe ends at an empty slot, there must be one */
+    empty = false;
+    for (i = 0; i < view->header->slot_count; i++) {
+        if (view->slots[i] > count) return false;
+        if (view->slots[i] == 0) empty = true;
+    }
+    return empty;
+}
+
+yy_file_view_t *_yy_file_view_open(const char *path, uint32_t magic) {
+    yy_file_view_t *view;
+    const yy_file_header_t *header;
+    struct stat st;
+    void *data;
+    int fd;
+    
+    if (path == NULL) return NULL;
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        yy_log_error("%s() cannot open file(%s)", __func__, path);
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(yy_file_header_t)) {
+        yy_log_error("%s() invalid file(%s)", __func__, path);
+        close(fd);
+        return NULL;
+    }
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        yy_log_error("%s() cannot map file(%s)", __func__, path);
+        return NULL;
+    }
+    
+    view = calloc(1, sizeof(yy_file_view_t));
+    if (view == NULL) {
+        yy_log_error("%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_file_view_t));
+        munmap(data, st.st_size);
+        return NULL;
+    }
+    view->ref_count = 1;
+    view->data = data;
+    view->size = st.st_size;
+    
+    header = data;
+    if (header->magic != magic || header->version != YY_FILE_VERSION
+        || (header->table_offset & 7) || (header->slot_offset & 7)
+        || !_yy_file_view_check(view, header->table_offset, header->count,
+                                magic == YY_FILE_MAP_MAGIC ? sizeof(yy_file_map_entry_t) : sizeof(uint64_t))
+        || !_yy_file_view_check(view, header->slot_offset, header->slot_count, sizeof(uint64_t))
+        || !_yy_file_view_check(view, header->blob_offset, header->blob_size, 1)
+        || (header->blob_size > 0 && ((const char *)data)[header->blob_offset + header->blob_size - 1] != '\0')
+        || (magic == YY_FILE_MAP_MAGIC && (header->slot_count == 0
+                                           || (header->slot_count & (header->slot_count - 1))
+                                           || header->slot_count <= header->count))) {
+        yy_log_error("%s() invalid file(%s)", __func__, path);
+        _yy_file_view_release(view);
+        return NULL;
+    }
+    view->header = header;
+    view->table = (const char *)data + header->table_offset;
+    view->slots = (const uint64_t *)((const char *)data + header->slot_offset);
+    view->blob = (const char *)data + header->blob_offset;
+    if (!_yy_file_view_check_table(view, magic)) {
+        yy_log_error("%s() invalid file(%s)", __func__, path);
+        _yy_file_view_release(view);
+        return NULL;
+    }
+    return view;
+}
+
+void _yy_file_view_retain(yy_file_view_t *view) {
+    __sync_fetch_and_add(&view->ref_count, 1);
+}
+
+void _yy_file_view_release(yy_file_view_t *view) {
+    if (__sync_sub_and_fetch(&view->ref_count, 1) > 0) return;
+    munmap(view->data, view->size);
+    free(view);
+}
+
+bool _yy_file_write(FILE *fp, const void *data, size_t size) {
+    return size == 0 || fwrite(data, 1, size, fp) == size;
+}
+
+bool _yy_file_pad(FILE *fp, uint64_t size) {
+    static const char zero[8] = {0};
+    size_t pad = (size_t)(_yy_file_align(size) - size);
+    return pad == 0 || fwrite(zero, 1, pad, fp) == pad;
+}
@@ -0,0 +1,83 @@
+//
+//  yy_file_private.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_file_private_h
+#define YYMidiBase_yy_file_private_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ Binary file layout (native byte order, every section is 8-byte aligned):
+
+ yy_array:  header | uint64 offsets[count]                         | blob
+ yy_map:    header | yy_file_map_entry_t entries[count] | uint64 slots[] | blob
+
+ The blob holds the NUL-terminated strings, offsets are relative to the
+ blob. Map slots are an open addressing index (linear probing), a slot
+ holds an entry index + 1, or 0 if empty.
+ */
+
+#define YY_FILE_ARRAY_MAGIC  0x41535959  ///< "YYSA"
+#define YY_FILE_MAP_MAGIC    0x4D535959  ///< "YYSM"
+#define YY_FILE_VERSION      1
+
+/// Offset used for a NULL value.
+#define YY_FILE_NULL_OFFSET  UINT64_MAX
+
+typedef struct _yy_file_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t count;
+    uint64_t table_offset;  ///< offsets (array) or entries (map)
+    uint64_t slot_offset;   ///< map only
+    uint64_t slot_count;    ///< map only, power of 2
+    uint64_t blob_offset;
+    uint64_t blob_size;
+} yy_file_header_t;
+
+typedef struct _yy_file_map_entry {
+    uint64_t hash;
+    uint64_t key;
+    uint64_t value;
+} yy_file_map_entry_t;
+
+/// A read-only mapped file, shared by the containers created from it.
+typedef struct _yy_file_view {
+    long ref_count;         ///< atomic, the containers may be used on different threads
+    void *data;
+    size_t size;
+    const yy_file_header_t *header;
+    const void *table;
+    const uint64_t *slots;
+    const char *blob;
+} yy_file_view_t;
+
+/// Map a file and check its sections, string offsets and slots, NULL if the file is invalid.
+yy_file_view_t *_yy_file_view_open(const char *path, uint32_t magic);
+void _yy_file_view_retain(yy_file_view_t *view);
+void _yy_file_view_release(yy_file_view_t *view);
+
+/// Get the string at offset of the blob (NULL for YY_FILE_NULL_OFFSET), the offset was checked at open.
+static inline const char *_yy_file_view_string(const yy_file_view_t *view, uint64_t offset) {
+    return offset == YY_FILE_NULL_OFFSET ? NULL : view->blob + offset;
+}
+
+/// Write size bytes to the file.
+bool _yy_file_write(FILE *fp, const void *data, size_t size);
+
+/// Pad a section of size bytes to 8-byte alignment.
+bool _yy_file_pad(FILE *fp, uint64_t size);
+
+/// Round a section size up to 8-byte alignment.
+static inline uint64_t _yy_file_align(uint64_t size) {
+    return (size + 7) & ~(uint64_t)7;
+}
+
+#endif
@@ -0,0 +1,337 @@
+//
+//  yy_heap.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_heap.h"
+#include "yy_base_private.h"
+#include "yy_log.h"
+
+#include <string.h>
+#include <limits.h>
+
+#define YY_HEAP_MIN_CAPACITY 16
+
+/// Children per node, 4 entries of 16 bytes fill a cache line.
+#define YY_HEAP_ARITY 4
+
+#define YY_HEAP_CACHE_LINE 64
+
+/// The buffer starts 3 entries before a cache line, so the children of every node (4i+1 ... 4i+4) are in one line.
+#define YY_HEAP_PADDING 3
+
+typedef struct _yy_heap_entry {
+    const void *value;
+    long handle;
+} yy_heap_entry_t;
+
+struct _yy_heap {
+    long count;
+    long capacity;
+    yy_heap_entry_t *entries;   ///< buffer + YY_HEAP_PADDING
+    yy_heap_entry_t *buffer;    ///< cache line aligned
+    long *positions;            ///< entry index of each live handle, or a free list link (< 0)
+    long handle_count;          ///< handles in use or free, <= capacity
+    long free_handle;           ///< head of the free list, or YY_NOT_FOUND
+    yy_array_callback_t callback;
+    yy_comparator_func cmp;
+    void *context;
+};
+
+/// A free handle stores the next free handle as -2 - next (YY_NOT_FOUND stays -1).
+#define YY_HEAP_FREE_LINK(next) (-2 - (next))
+
+yy_inline bool _yy_heap_before(yy_heap_t *heap, const void *value1, const void *value2) {
+    return heap->cmp(value1, value2, heap->context) == YY_ORDER_ASC;
+}
+
+yy_inline void _yy_heap_place(yy_heap_t *heap, long index, yy_heap_entry_t entry) {
+    heap->entries[index] = entry;
+    heap->positions[entry.handle] = index;
+}
+
+static void _yy_heap_sift_up(yy_heap_t *heap, long index, yy_heap_entry_t entry) {
+    long parent;
+    
+    while (index > 0) {
+        parent = (index - 1) / YY_HEAP_ARITY;
+        if (!_yy_heap_before(heap, entry.value, heap->entries[parent].value)) break;
+        _yy_heap_place(heap, index, heap->entries[parent]);
+        index = parent;
+    }
+    _yy_heap_place(heap, index, entry);
+}
+
+static void _yy_heap_sift_down(yy_heap_t *heap, long index, yy_heap_entry_t entry) {
+    long first, last, best, i;
+    
+    for (;;) {
+        first = index * YY_HEAP_ARITY + 1;
+        if (first >= heap->count) break;
+        last = YY_MIN(first + YY_HEAP_ARITY, heap->count);
+        best = first;
+        for (i = first + 1; i < last; i++) {
+            if (_yy_heap_before(heap, heap->entries[i].value, heap->entries[best].value)) best = i;
+        }
+        if (!_yy_heap_before(heap, heap->entries[best].value, entry.value)) break;
+        _yy_heap_place(heap, index, heap->entries[best]);
+        index = best;
+    }
+    _yy_heap_place(heap, index, entry);
+}
+
+/// Move the entry at index up or down to its position.
+yy_inline void _yy_heap_fix(yy_heap_t *heap, long index) {
+    yy_heap_entry_t entry = heap->entries[index];
+    
+    if (index > 0 && _yy_heap_before(heap, entry.value, heap->entries[(index - 1) / YY_HEAP_ARITY].value)) {
+        _yy_heap_sift_up(heap, index, entry);
+    } else {
+        _yy_heap_sift_down(heap, index, entry);
+    }
+}
+
+yy_inline long _yy_heap_alloc_handle(yy_heap_t *heap) {
+    long handle;
+    
+    if (heap->free_handle != YY_NOT_FOUND) {
+        handle = heap->free_handle;
+        heap->free_handle = YY_HEAP_FREE_LINK(heap->positions[handle]);
+        return handle;
+    }
+    return heap->handle_count++;
+}
+
+yy_inline void _yy_heap_free_handle(yy_heap_t *heap, long handle) {
+    heap->positions[handle] = YY_HEAP_FREE_LINK(heap->free_handle);
+    heap->free_handle = handle;
+}
+
+yy_inline bool _yy_heap_validate_handle(yy_heap_t *heap, long handle, const char *func) {
+    if (handle < 0 || handle >= heap->handle_count || heap->positions[handle] < 0) {
+        yy_log_error("yy_heap_t(%p):%s() invalid handle(%ld)", heap, func, handle);
+        return false;
+    }
+    return true;
+}
+
+/// Remove the entry at index and return its value (not released).
+static const void * _yy_heap_remove_at(yy_heap_t *heap, long index) {
+    yy_heap_entry_t entry;
+    
+    entry = heap->entries[index];
+    _yy_heap_free_handle(heap, entry.handle);
+    heap->count--;
+    if (index != heap->count) {
+        heap->entries[index] = heap->entries[heap->count];
+        heap->positions[heap->entries[index].handle] = index;
+        _yy_heap_fix(heap, index);
+    }
+    return entry.value;
+}
+
+yy_inline void _yy_heap_hand_over(yy_heap_t *heap, const void *value, const void **out) {
+    if (out) *out = value;
+    else if (heap->callback.release) heap->callback.release(value);
+}
+
+static void _yy_heap_dealloc(yy_heap_t *heap) {
+    yy_heap_clear(heap);
+    free(heap->buffer);
+    free(heap->positions);
+    yy_dealloc(heap);
+}
+
+yy_heap_t *yy_heap_create(yy_comparator_func cmp, void *context) {
+    return yy_heap_create_with_options(0, NULL, cmp, context);
+}
+
+yy_heap_t *yy_heap_create_with_options(long capacity, const yy_array_callback_t *callback,
+                                       yy_comparator_func cmp, void *context) {
+    yy_heap_t *heap;
+    
+    if (capacity < 0) {
+        yy_log_error("%s() capacity(%ld) cannot be less than zero", __func__, capacity);
+        return NULL;
+    }
+    if (cmp == NULL) {
+        yy_log_error("%s() cmp cannot be NULL", __func__);
+        return NULL;
+    }
+    heap = yy_alloc(yy_heap_t, _yy_heap_dealloc);
+    if (heap == NULL) {
+        yy_log_error("yy_heap_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_heap_t));
+        return NULL;
+    }
+    if (callback) heap->callback = *callback;
+    heap->cmp = cmp;
+    heap->context = context;
+    heap->free_handle = YY_NOT_FOUND;
+    if (!yy_heap_reserve(heap, YY_MAX(capacity, YY_HEAP_MIN_CAPACITY))) {
+        yy_release(heap);
+        return NULL;
+    }
+    return heap;
+}
+
+yy_heap_t *yy_heap_create_with_array(yy_array_t *array, const yy_array_callback_t *callback,
+                                     yy_comparator_func cmp, void *context) {
+    yy_heap_t *heap;
+    const void *value;
+    long i, count;
+    
+    if (array == NULL) {
+        yy_log_error("%s() input array cannot be null", __func__);
+        return NULL;
+    }
+    count = yy_array_count(array);
+    heap = yy_heap_create_with_options(count, callback, cmp, context);
+    if (heap == NULL) return NULL;
+    for (i = 0; i < count; i++) {
+        value = yy_array_get(array, i);
+        heap->entries[i].value = heap->callback.retain ? heap->callback.retain(value) : value;
+        heap->entries[i].handle = i;
+        heap->positions[i] = i;
+    }
+    heap->count = count;
+    heap->handle_count = count;
+    
+    /* Floyd: sift down every parent, from the last one */
+    for (i = (count - 2) / YY_HEAP_ARITY; i >= 0 && count > 1; i--) {
+        _yy_heap_sift_down(heap, i, heap->entries[i]);
+    }
+    return heap;
+}
+
+long yy_heap_count(yy_heap_t *heap) {
+    return heap->count;
+}
+
+bool yy_heap_reserve(yy_heap_t *heap, long count) {
+    yy_heap_entry_t *buffer;
+    long *positions;
+    long capacity;
+    void *memory;
+    
+    if (count < 0) {
+        yy_log_error("yy_heap_t(%p):%s() count(%ld) cannot be less than zero", heap, __func__, count);
+        return false;
+    }
+    if (count <= heap->capacity) return true;
+    capacity = YY_MAX(heap->capacity, YY_HEAP_MIN_CAPACITY);
+    while (capacity < count) {
+        if (capacity > LONG_MAX / 2 / (long)sizeof(yy_heap_entry_t)) {
+            yy_log_error("yy_heap_t(%p):%s() count(%ld) overflow", heap, __func__, count);
+            return false;
+        }
+        capacity <<= 1;
+    }
+    if (posix_memalign(&memory, YY_HEAP_CACHE_LINE, (capacity + YY_HEAP_PADDING) * sizeof(yy_heap_entry_t)) != 0) {
+        yy_log_error("yy_heap_t(%p):%s() attempt to allocate %ld bytes failed",
+                     heap, __func__, (capacity + YY_HEAP_PADDING) * sizeof(yy_heap_entry_t));
+        return false;
+    }
+    buffer = memory;
+    positions = realloc(heap->positions, capacity * sizeof(long));
+    if (positions == NULL) {
+        yy_log_error("yy_heap_t(%p):%s() attempt to allocate %ld bytes failed",
+                     heap, __func__, capacity * sizeof(long));
+        free(buffer);
+        return false;
+    }
+    if (heap->count > 0) memcpy(buffer + YY_HEAP_PADDING, heap->entries, heap->count * sizeof(yy_heap_entry_t));
+    free(heap->buffer);
+    heap->buffer = buffer;
+    heap->entries = buffer + YY_HEAP_PADDING;
+    heap->positions = positions;
+    heap->capacity = capacity;
+    YY_REGISTRY_SET_BYTES(heap, sizeof(yy_heap_t) + capacity * (sizeof(yy_heap_entry_t) + sizeof(long)));
+    return true;
+}
+
+long yy_heap_push(yy_heap_t *heap, const void *value) {
+    yy_heap_entry_t entry;
+    
+    if (!yy_heap_reserve(heap, heap->count + 1)) return YY_NOT_FOUND;
+    entry.value = heap->callback.retain ? heap->callback.retain(value) : value;
+    entry.handle = _yy_heap_alloc_handle(heap);
+    heap->count++;
+    _yy_heap_sift_up(heap, heap->count - 1, entry);
+    return entry.handle;
+}
+
+const void *yy_heap_peek(yy_heap_t *heap) {
+    return heap->count > 0 ? heap->entries[0].value : NULL;
+}
+
+bool yy_heap_pop(yy_heap_t *heap, const void **value) {
+    if (heap->count == 0) return false;
+    _yy_heap_hand_over(heap, _yy_heap_remove_at(heap, 0), value);
+    return true;
+}
+
+long yy_heap_replace_top(yy_heap_t *heap, const void *value, const void **old_top) {
+    yy_heap_entry_t entry;
+    const void *top;
+    
+    if (heap->count == 0) return YY_NOT_FOUND;
+    top = heap->entries[0].value;
+    
+    /* the new value takes over the handle of the old top */
+    entry.value = heap->callback.retain ? heap->callback.retain(value) : value;
+    entry.handle = heap->entries[0].handle;
+    _yy_heap_sift_down(heap, 0, entry);
+    _yy_heap_hand_over(heap, top, old_top);
+    return entry.handle;
+}
+
+const void *yy_heap_get(yy_heap_t *heap, long handle) {
+    if (!_yy_heap_validate_handle(heap, handle, __func__)) return NULL;
+    return heap->entries[heap->positions[handle]].value;
+}
+
+bool yy_heap_update(yy_heap_t *heap, long handle, const void *value) {
+    yy_heap_entry_t *entry;
+    
+    if (!_yy_heap_validate_handle(heap, handle, __func__)) return false;
+    entry = heap->entries + heap->positions[handle];
+    if (entry->value != value) {
+        if (heap->callback.retain) value = heap->callback.retain(value);
+        if (heap->callback.release) heap->callback.release(entry->value);
+        entry->value = value;
+    }
+    _yy_heap_fix(heap, heap->positions[handle]);
+    return true;
+}
+
+bool yy_heap_remove(yy_heap_t *heap, long handle, const void **value) {
+    if (!_yy_heap_validate_handle(heap, handle, __func__)) return false;
+    _yy_heap_hand_over(heap, _yy_heap_remove_at(heap, heap->positions[handle]), value);
+    return true;
+}
+
+bool yy_heap_clear(yy_heap_t *heap) {
+    long i;
+    
+    if (heap->callback.release) {
+        for (i = 0; i < heap->count; i++) heap->callback.release(heap->entries[i].value);
+    }
+    heap->count = 0;
+    heap->handle_count = 0;
+    heap->free_handle = YY_NOT_FOUND;
+    return true;
+}
+
+bool yy_heap_foreach(yy_heap_t *heap, yy_array_foreach_func func, void *context) {
+    long i;
+    
+    if (func == NULL) return false;
+    for (i = 0; i < heap->count; i++) {
+        func(heap->entries[i].handle, heap->entries[i].value, context);
+    }
+    return true;
+}
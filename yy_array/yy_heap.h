@@ -0,0 +1,85 @@
+//
+//  yy_heap.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_heap_h
+#define YYMidiBase_yy_heap_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yy_base.h"
+#include "yy_array.h"
+
+/**
+ YY Heap  (priority queue)
+ 
+ A 4-ary heap in one contiguous buffer: the 4 children of a node share a
+ cache line, so the tree is half as deep as a binary heap. The top is the
+ value that sorts first with the comparator (YY_ORDER_ASC = value1 first).
+ 
+ Every pushed value gets a handle, valid until the value leaves the heap,
+ to read, update (decrease-key or increase-key) or remove it in O(log n).
+ Handles of removed values are reused.
+ 
+ Values are retained/released with the callback (like yy_array). The pop
+ functions hand the reference to the caller instead of releasing it.
+ 
+ Example:
+ yy_heap_t *heap = yy_heap_create(cmp, NULL);
+ long handle = yy_heap_push(heap, event1);
+ yy_heap_push(heap, event2);
+ event1->time = 0;
+ yy_heap_update(heap, handle, event1); // event1 moved to the top
+ const void *first;
+ yy_heap_pop(heap, &first);
+ yy_release(heap);
+ */
+typedef struct _yy_heap yy_heap_t;
+
+yy_heap_t *yy_heap_create(yy_comparator_func cmp, void *context);
+yy_heap_t *yy_heap_create_with_options(long capacity, const yy_array_callback_t *callback,
+                                       yy_comparator_func cmp, void *context);
+/// Create a heap of the values of array in O(n), the handle of the value at index i is i.
+yy_heap_t *yy_heap_create_with_array(yy_array_t *array, const yy_array_callback_t *callback,
+                                     yy_comparator_func cmp, void *context);
+
+long yy_heap_count(yy_heap_t *heap);
+/// Returns the handle of the value, or YY_NOT_FOUND on failure.
+long yy_heap_push(yy_heap_t *heap, const void *value);
+/// Returns the top value (NULL if the heap is empty).
+const void *yy_heap_peek(yy_heap_t *heap);
+/// Remove the top value and hand it to the caller (released if value is NULL). Returns false if the heap is empty.
+bool yy_heap_pop(yy_heap_t *heap, const void **value);
+
+/**
+ Pop the top value and push a new one, with a single sift (faster than pop + push).
+ 
+ @param old_top receives the old top (released if NULL)
+ @return the handle of the new value, or YY_NOT_FOUND if the heap is empty.
+ */
+long yy_heap_replace_top(yy_heap_t *heap, const void *value, const void **old_top);
+
+/// Returns the value of a handle (NULL if the handle is invalid).
+const void *yy_heap_get(yy_heap_t *heap, long handle);
+/**
+ Replace the value of a handle (or pass the same value after changing its
+ key in place) and move it to its new position.
+ */
+bool yy_heap_update(yy_heap_t *heap, long handle, const void *value);
+/// Remove the value of a handle and hand it to the caller (released if value is NULL).
+bool yy_heap_remove(yy_heap_t *heap, long handle, const void **value);
+bool yy_heap_clear(yy_heap_t *heap);
+/// Make room for `count` values without reallocating.
+bool yy_heap_reserve(yy_heap_t *heap, long count);
+
+/// Apply func to every value, in storage order (not sorted). The index is the handle.
+bool yy_heap_foreach(yy_heap_t *heap, yy_array_foreach_func func, void *context);
+
+#endif
@@ -0,0 +1,316 @@
+//
+//  yy_int_map.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_int_map.h"
+#include "yy_base_private.h"
+#include "yy_log.h"
+
+#include <string.h>
+#include <limits.h>
+
+/// Minimum slot count, the slot count is always a power of 2.
+#define YY_INT_MAP_MIN_CAPACITY 16
+
+/// Key 0 marks an empty slot, the entry for key 0 is kept outside the table.
+#define YY_INT_MAP_EMPTY_KEY 0
+
+typedef struct _yy_int_map_slot {
+    uint64_t key;
+    uint64_t value;
+} yy_int_map_slot_t;
+
+struct _yy_int_map {
+    long count;             ///< including the zero key
+    long capacity;          ///< slot count
+    long max_count;         ///< grow when the table holds more keys (3/4 of capacity)
+    yy_int_map_slot_t *slots;
+    bool has_zero_key;
+    uint64_t zero_value;
+};
+
+yy_inline long _yy_int_map_table_count(yy_int_map_t *map) {
+    return map->count - (map->has_zero_key ? 1 : 0);
+}
+
+yy_inline long _yy_int_map_capacity_for_count(long count) {
+    long capacity = YY_INT_MAP_MIN_CAPACITY;
+    while (capacity - capacity / 4 < count) capacity <<= 1;
+    return capacity;
+}
+
+/// Returns the slot of key, or NULL (key must not be 0).
+yy_inline yy_int_map_slot_t *_yy_int_map_find(yy_int_map_t *map, uint64_t key) {
+    yy_int_map_slot_t *slot;
+    unsigned long mask, index;
+    
+    if (map->slots == NULL) return NULL;
+    mask = map->capacity - 1;
+    index = _yy_hash_mix(key) & mask;
+    for (;;) {
+        slot = map->slots + index;
+        if (slot->key == key) return slot;
+        if (slot->key == YY_INT_MAP_EMPTY_KEY) return NULL;
+        index = (index + 1) & mask;
+    }
+}
+
+/// Returns the slot of key, or the empty slot where it should be inserted.
+yy_inline yy_int_map_slot_t *_yy_int_map_probe(yy_int_map_slot_t *slots, long capacity, uint64_t key) {
+    yy_int_map_slot_t *slot;
+    unsigned long mask, index;
+    
+    mask = capacity - 1;
+    index = _yy_hash_mix(key) & mask;
+    for (;;) {
+        slot = slots + index;
+        if (slot->key == key || slot->key == YY_INT_MAP_EMPTY_KEY) return slot;
+        index = (index + 1) & mask;
+    }
+}
+
+static bool _yy_int_map_resize(yy_int_map_t *map, long capacity) {
+    yy_int_map_slot_t *slots, *slot;
+    long i;
+    
+    if (capacity > LONG_MAX / (long)sizeof(yy_int_map_slot_t)) {
+        yy_log_error("yy_int_map_t(%p):%s() capacity(%ld) overflow", map, __func__, capacity);
+        return false;
+    }
+    slots = calloc(capacity, sizeof(yy_int_map_slot_t));
+    if (slots == NULL) {
+        yy_log_error("yy_int_map_t(%p):%s() attempt to allocate %ld bytes failed",
+                     map, __func__, capacity * sizeof(yy_int_map_slot_t));
+        return false;
+    }
+    if (map->slots) {
+        for (i = 0; i < map->capacity; i++) {
+            if (map->slots[i].key == YY_INT_MAP_EMPTY_KEY) continue;
+            slot = _yy_int_map_probe(slots, capacity, map->slots[i].key);
+            *slot = map->slots[i];
+        }
+        free(map->slots);
+    }
+    map->slots = slots;
+    map->capacity = capacity;
+    map->max_count = capacity - capacity / 4;
+    YY_REGISTRY_SET_BYTES(map, yy_int_map_get_memory_size(map));
+    return true;
+}
+
+/// Returns the slot of key, inserting it with value 0 if needed (key must not be 0).
+static yy_int_map_slot_t *_yy_int_map_insert(yy_int_map_t *map, uint64_t key) {
+    yy_int_map_slot_t *slot;
+    
+    if (map->slots == NULL || _yy_int_map_table_count(map) >= map->max_count) {
+        slot = _yy_int_map_find(map, key);
+        if (slot) return slot;
+        if (!_yy_int_map_resize(map, _yy_int_map_capacity_for_count(_yy_int_map_table_count(map) + 1))) {
+            return NULL;
+        }
+    }
+    slot = _yy_int_map_probe(map->slots, map->capacity, key);
+    if (slot->key == YY_INT_MAP_EMPTY_KEY) {
+        slot->key = key;
+        slot->value = 0;
+        map->count++;
+    }
+    return slot;
+}
+
+static void _yy_int_map_dealloc(yy_int_map_t *map) {
+    free(map->slots);
+    yy_dealloc(map);
+}
+
+yy_int_map_t *yy_int_map_create() {
+    return yy_int_map_create_with_capacity(0);
+}
+
+yy_int_map_t *yy_int_map_create_with_capacity(long capacity) {
+    yy_int_map_t *map;
+    
+    if (capacity < 0) {
+        yy_log_error("%s() capacity(%ld) cannot be less than zero", __func__, capacity);
+        return NULL;
+    }
+    map = yy_alloc(yy_int_map_t, _yy_int_map_dealloc);
+    if (map == NULL) {
+        yy_log_error("yy_int_map_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_int_map_t));
+        return NULL;
+    }
+    if (capacity > 0 && !_yy_int_map_resize(map, _yy_int_map_capacity_for_count(capacity))) {
+        yy_release(map);
+        return NULL;
+    }
+    return map;
+}
+
+long yy_int_map_count(yy_int_map_t *map) {
+    return map->count;
+}
+
+bool yy_int_map_contains_key(yy_int_map_t *map, uint64_t key) {
+    if (key == YY_INT_MAP_EMPTY_KEY) return map->has_zero_key;
+    return _yy_int_map_find(map, key) != NULL;
+}
+
+bool yy_int_map_get(yy_int_map_t *map, uint64_t key, uint64_t *value) {
+    yy_int_map_slot_t *slot;
+    
+    if (key == YY_INT_MAP_EMPTY_KEY) {
+        if (!map->has_zero_key) return false;
+        if (value) *value = __atomic_load_n(&map->zero_value, __ATOMIC_RELAXED);
+        return true;
+    }
+    slot = _yy_int_map_find(map, key);
+    if (slot == NULL) return false;
+    if (value) *value = __atomic_load_n(&slot->value, __ATOMIC_RELAXED);
+    return true;
+}
+
+void *yy_int_map_get_pointer(yy_int_map_t *map, uint64_t key) {
+    uint64_t value;
+    
+    if (!yy_int_map_get(map, key, &value)) return NULL;
+    return (void *)(uintptr_t)value;
+}
+
+bool yy_int_map_set(yy_int_map_t *map, uint64_t key, uint64_t value) {
+    yy_int_map_slot_t *slot;
+    
+    if (key == YY_INT_MAP_EMPTY_KEY) {
+        if (!map->has_zero_key) {
+            map->has_zero_key = true;
+            map->count++;
+        }
+        map->zero_value = value;
+        return true;
+    }
+    slot = _yy_int_map_insert(map, key);
+    if (slot == NULL) return false;
+    slot->value = value;
+    return true;
+}
+
+bool yy_int_map_set_pointer(yy_int_map_t *map, uint64_t key, const void *value) {
+    return yy_int_map_set(map, key, (uint64_t)(uintptr_t)value);
+}
+
+bool yy_int_map_remove(yy_int_map_t *map, uint64_t key) {
+    yy_int_map_slot_t *slot;
+    unsigned long mask, hole, index, home;
+    
+    if (key == YY_INT_MAP_EMPTY_KEY) {
+        if (!map->has_zero_key) return false;
+        map->has_zero_key = false;
+        map->zero_value = 0;
+        map->count--;
+        return true;
+    }
+    slot = _yy_int_map_find(map, key);
+    if (slot == NULL) return false;
+    
+    // shift back the following slots of the cluster which may not stay behind the hole
+    mask = map->capacity - 1;
+    hole = slot - map->slots;
+    index = hole;
+    for (;;) {
+        index = (index + 1) & mask;
+        slot = map->slots + index;
+        if (slot->key == YY_INT_MAP_EMPTY_KEY) break;
+        home = _yy_hash_mix(slot->key) & mask;
+        if (((index - home) & mask) >= ((index - hole) & mask)) {
+            map->slots[hole] = *slot;
+            hole = index;
+        }
+    }
+    map->slots[hole].key = YY_INT_MAP_EMPTY_KEY;
+    map->slots[hole].value = 0;
+    map->count--;
+    return true;
+}
+
+bool yy_int_map_clear(yy_int_map_t *map) {
+    free(map->slots);
+    map->slots = NULL;
+    map->capacity = 0;
+    map->max_count = 0;
+    map->count = 0;
+    map->has_zero_key = false;
+    map->zero_value = 0;
+    YY_REGISTRY_SET_BYTES(map, yy_int_map_get_memory_size(map));
+    return true;
+}
+
+bool yy_int_map_reserve(yy_int_map_t *map, long count) {
+    long capacity;
+    
+    if (count < 0) {
+        yy_log_error("yy_int_map_t(%p):%s() count(%ld) cannot be less than zero", map, __func__, count);
+        return false;
+    }
+    capacity = _yy_int_map_capacity_for_count(count);
+    if (capacity <= map->capacity) return true;
+    return _yy_int_map_resize(map, capacity);
+}
+
+bool yy_int_map_foreach(yy_int_map_t *map, yy_int_map_foreach_func func, void *context) {
+    long i;
+    
+    if (func == NULL) {
+        yy_log_error("yy_int_map_t(%p):%s() func cannot be NULL", map, __func__);
+        return false;
+    }
+    if (map->has_zero_key) func(YY_INT_MAP_EMPTY_KEY, map->zero_value, context);
+    for (i = 0; i < map->capacity; i++) {
+        if (map->slots[i].key != YY_INT_MAP_EMPTY_KEY) {
+            func(map->slots[i].key, map->slots[i].value, context);
+        }
+    }
+    return true;
+}
+
+uint64_t yy_int_map_increment(yy_int_map_t *map, uint64_t key, int64_t delta) {
+    yy_int_map_slot_t *slot;
+    
+    if (key == YY_INT_MAP_EMPTY_KEY) {
+        if (!map->has_zero_key) {
+            map->has_zero_key = true;
+            map->count++;
+        }
+        map->zero_value += (uint64_t)delta;
+        return map->zero_value;
+    }
+    slot = _yy_int_map_insert(map, key);
+    if (slot == NULL) return 0;
+    slot->value += (uint64_t)delta;
+    return slot->value;
+}
+
+bool yy_int_map_atomic_add(yy_int_map_t *map, uint64_t key, int64_t delta, uint64_t *result) {
+    yy_int_map_slot_t *slot;
+    uint64_t *value;
+    uint64_t sum;
+    
+    if (key == YY_INT_MAP_EMPTY_KEY) {
+        if (!map->has_zero_key) return false;
+        value = &map->zero_value;
+    } else {
+        slot = _yy_int_map_find(map, key);
+        if (slot == NULL) return false;
+        value = &slot->value;
+    }
+    sum = __atomic_add_fetch(value, (uint64_t)delta, __ATOMIC_RELAXED);
+    if (result) *result = sum;
+    return true;
+}
+
+long yy_int_map_get_memory_size(yy_int_map_t *map) {
+    return sizeof(yy_int_map_t) + map->capacity * sizeof(yy_int_map_slot_t);
+}
@@ -0,0 +1,78 @@
+//
+//  yy_int_map.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_int_map_h
+#define YYMidiBase_yy_int_map_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yy_base.h"
+
+/// Prototype of a callback function that may be applied to every key-value pair in an int map.
+typedef void (*yy_int_map_foreach_func)(uint64_t key, uint64_t value, void *context);
+
+/**
+ YY Int Map  (uint64 keys and values, stored inline)
+ 
+ An open addressing (linear probing) table of 16-byte key-value slots, with
+ no callbacks and no per-entry allocation. Keys are mixed before probing, so
+ sequential ids spread over the table. Removal shifts the following slots
+ back, no tombstones are left. Pointers can be stored as values with
+ yy_int_map_set_pointer() / yy_int_map_get_pointer().
+ 
+ Like the other yy containers the map is not thread safe, except for
+ yy_int_map_atomic_add(): it updates the value of an existing key in place
+ and may be called from several threads at once, as long as no thread
+ inserts or removes keys at the same time.
+ 
+ Example:
+ yy_int_map_t *map = yy_int_map_create();
+ yy_int_map_set(map, 42, 1);
+ yy_int_map_increment(map, 42, 1);
+ uint64_t value;
+ yy_int_map_get(map, 42, &value); // value == 2
+ yy_release(map);
+ */
+typedef struct _yy_int_map yy_int_map_t;
+
+yy_int_map_t *yy_int_map_create();
+yy_int_map_t *yy_int_map_create_with_capacity(long capacity);
+
+long yy_int_map_count(yy_int_map_t *map);
+bool yy_int_map_contains_key(yy_int_map_t *map, uint64_t key);
+/// Returns false if the key is not found (value is not modified).
+bool yy_int_map_get(yy_int_map_t *map, uint64_t key, uint64_t *value);
+/// Returns NULL if the key is not found.
+void *yy_int_map_get_pointer(yy_int_map_t *map, uint64_t key);
+bool yy_int_map_set(yy_int_map_t *map, uint64_t key, uint64_t value);
+bool yy_int_map_set_pointer(yy_int_map_t *map, uint64_t key, const void *value);
+bool yy_int_map_remove(yy_int_map_t *map, uint64_t key);
+bool yy_int_map_clear(yy_int_map_t *map);
+/// Make room for `count` keys without resizing.
+bool yy_int_map_reserve(yy_int_map_t *map, long count);
+bool yy_int_map_foreach(yy_int_map_t *map, yy_int_map_foreach_func func, void *context);
+
+/// Add `delta` to the value of `key` (a missing key starts at 0). Returns the new value, or 0 if the map cannot grow.
+uint64_t yy_int_map_increment(yy_int_map_t *map, uint64_t key, int64_t delta);
+
+/**
+ Atomically add `delta` to the value of an existing key.
+ Safe against other yy_int_map_atomic_add() and yy_int_map_get() calls, but
+ not against concurrent insertion or removal.
+ 
+ @return false if the key is not found.
+ */
+bool yy_int_map_atomic_add(yy_int_map_t *map, uint64_t key, int64_t delta, uint64_t *result);
+
+/// Bytes used by the map (table and header).
+long yy_int_map_get_memory_size(yy_int_map_t *map);
+
+#endif
@@ -7,28 +7,54 @@
 //
 
 #include "yy_log.h"
+#include "yy_base.h"
+#include "yy_base_private.h"
 
 #include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <pthread.h>
 
 yy_LOG_LEVEL yy_log_level = yy_DEFAULT_LOG_LEVEL;
 
 static void _default_yy_log_func(yy_LOG_LEVEL level, char *fmt, va_list args);
 void (*yy_log_func)(yy_LOG_LEVEL level, char *fmt, va_list args) = _default_yy_log_func;
 
+static void _default_yy_log_async_output_func(yy_LOG_LEVEL level, const char *message);
+void (*yy_log_async_output_func)(yy_LOG_LEVEL level, const char *message) = _default_yy_log_async_output_func;
+
+static bool _yy_log_async_running;
+static void _yy_log_async_push(yy_LOG_LEVEL level, char *fmt, va_list args);
+
+
+static const char * _yy_log_prefix(yy_LOG_LEVEL level) {
+    switch (level) {
+        case yy_LOG_LEVEL_ALL: return "[yy_LOG] ";
+        case yy_LOG_LEVEL_INFO: return "[yy_INFO] ";
+        case yy_LOG_LEVEL_WARN: return "[yy_WARN] ";
+        case yy_LOG_LEVEL_ERROR: return "[yy_ERROR] ";
+        default: return "";
+    }
+}
 
 static void _default_yy_log_func(yy_LOG_LEVEL level, char *fmt, va_list args) {
     if (level < yy_log_level || level >= yy_LOG_LEVEL_OFF) return;
-    switch (level) {
-        case yy_LOG_LEVEL_ALL: printf("[yy_LOG] "); break;
-        case yy_LOG_LEVEL_INFO: printf("[yy_INFO] "); break;
-        case yy_LOG_LEVEL_WARN: printf("[yy_WARN] "); break;
-        case yy_LOG_LEVEL_ERROR: printf("[yy_ERROR] "); break;
-        default:  break;
+    if (__atomic_load_n(&_yy_log_async_running, __ATOMIC_ACQUIRE)) {
+        _yy_log_async_push(level, fmt, args);
+        return;
     }
+    printf("%s", _yy_log_prefix(level));
     vprintf(fmt, args);
     printf("\n");
 }
 
+static void _default_yy_log_async_output_func(yy_LOG_LEVEL level, const char *message) {
+    printf("%s%s\n", _yy_log_prefix(level), message);
+}
+
 #define yy_DO_LOG(level) do { \
     va_list args; \
     va_start(args, fmt); \
@@ -36,18 +62,453 @@ static void _default_yy_log_func(yy_LOG_LEVEL level, char *fmt, va_list args) {
     va_end(args); \
 } while (0)
 
-void yy_log(yy_LOG_LEVEL level, char *fmt, ...) {
+/* the parentheses keep the macros of yy_log.h from expanding */
+
+void (yy_log)(yy_LOG_LEVEL level, char *fmt, ...) {
     yy_DO_LOG(level);
 }
 
-void yy_log_info(char *fmt, ...) {
+void (yy_log_info)(char *fmt, ...) {
     yy_DO_LOG(yy_LOG_LEVEL_INFO);
 }
 
-void yy_log_warn(char *fmt, ...) {
+void (yy_log_warn)(char *fmt, ...) {
     yy_DO_LOG(yy_LOG_LEVEL_WARN);
 }
 
-void yy_log_error(char *fmt, ...) {
+void (yy_log_error)(char *fmt, ...) {
     yy_DO_LOG(yy_LOG_LEVEL_ERROR);
 }
+
+
+
+#define YY_LOG_RING_SIZE 256        ///< records per thread, power of 2
+#define YY_LOG_MAX_ARGS 8           ///< arguments per record, '*' width and precision included
+#define YY_LOG_TEXT_SIZE 192        ///< bytes of copied %s strings per record
+#define YY_LOG_SPEC_SIZE 32         ///< max length of a conversion specification
+#define YY_LOG_MESSAGE_SIZE 1024    ///< max length of a formatted message
+#define YY_LOG_POLL_INTERVAL 1000   ///< microseconds between two drains
+
+typedef enum {
+    YY_LOG_LENGTH_NONE,
+    YY_LOG_LENGTH_HH,
+    YY_LOG_LENGTH_H,
+    YY_LOG_LENGTH_L,
+    YY_LOG_LENGTH_LL,
+    YY_LOG_LENGTH_J,
+    YY_LOG_LENGTH_Z,
+    YY_LOG_LENGTH_T,
+    YY_LOG_LENGTH_LD,
+} yy_log_length;
+
+/// A parsed conversion specification: '%' flags width precision length conversion.
+typedef struct _yy_log_spec {
+    const char *options;        ///< flags, width and precision
+    long options_length;
+    int stars;                  ///< number of '*' in width and precision
+    yy_log_length length;
+    char conversion;
+    const char *end;            ///< after the conversion
+} yy_log_spec_t;
+
+typedef union _yy_log_arg {
+    long long i;                ///< integer, char, '*' value or offset of a string in text (-1 for NULL)
+    double d;
+    const void *p;
+} yy_log_arg_t;
+
+typedef struct _yy_log_record {
+    yy_LOG_LEVEL level;
+    int arg_count;
+    const char *fmt;            ///< NULL if text holds the formatted message
+    yy_log_arg_t args[YY_LOG_MAX_ARGS];
+    char text[YY_LOG_TEXT_SIZE];
+} yy_log_record_t;
+
+/// Single producer (the owner thread), single consumer (the drainer).
+typedef struct _yy_log_ring {
+    struct _yy_log_ring *next;
+    unsigned long head;         ///< written by the owner
+    unsigned long tail;         ///< written by the drainer
+    bool dead;                  ///< the owner exited
+    yy_log_record_t records[YY_LOG_RING_SIZE];
+} yy_log_ring_t;
+
+static pthread_once_t _yy_log_async_once = PTHREAD_ONCE_INIT;
+static pthread_key_t _yy_log_ring_key;
+static pthread_mutex_t _yy_log_rings_lock;      ///< protects the ring list
+static pthread_mutex_t _yy_log_drain_lock;      ///< held while draining
+static pthread_mutex_t _yy_log_control_lock;    ///< held by start/stop
+static yy_log_ring_t *_yy_log_rings;
+static __thread yy_log_ring_t *_yy_log_current_ring;
+static pthread_t _yy_log_async_thread;
+static bool _yy_log_async_stopping;
+static unsigned long _yy_log_dropped_count;
+static unsigned long _yy_log_reported_count;    ///< drops already reported, drainer only
+static char _yy_log_message[YY_LOG_MESSAGE_SIZE]; ///< drainer only
+
+/**
+ Called at thread exit, the drainer frees the ring once it is empty. A log
+ made later in the thread teardown (another destructor) registers a new ring.
+ */
+static void _yy_log_ring_destructor(void *value) {
+    yy_log_ring_t *ring = value;
+    _yy_log_current_ring = NULL;
+    __atomic_store_n(&ring->dead, true, __ATOMIC_RELEASE);
+}
+
+static void _yy_log_async_init() {
+    pthread_mutex_init(&_yy_log_rings_lock, NULL);
+    pthread_mutex_init(&_yy_log_drain_lock, NULL);
+    pthread_mutex_init(&_yy_log_control_lock, NULL);
+    pthread_key_create(&_yy_log_ring_key, _yy_log_ring_destructor);
+}
+
+/**
+ Parse a specification, p points after the '%'.
+ Returns false for the ones that cannot be recorded (unknown, wide strings).
+ */
+static bool _yy_log_parse_spec(const char *p, yy_log_spec_t *spec) {
+    spec->options = p;
+    spec->stars = 0;
+    while (*p && strchr("-+ #0'", *p)) p++;
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->stars++;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') p++;
+        }
+    }
+    spec->options_length = p - spec->options;
+    switch (*p) {
+        case 'h':
+            if (p[1] == 'h') {
+                spec->length = YY_LOG_LENGTH_HH;
+                p++;
+            } else {
+                spec->length = YY_LOG_LENGTH_H;
+            }
+            p++;
+            break;
+        case 'l':
+            if (p[1] == 'l') {
+                spec->length = YY_LOG_LENGTH_LL;
+                p++;
+            } else {
+                spec->length = YY_LOG_LENGTH_L;
+            }
+            p++;
+            break;
+        case 'q': spec->length = YY_LOG_LENGTH_LL; p++; break;
+        case 'j': spec->length = YY_LOG_LENGTH_J; p++; break;
+        case 'z': spec->length = YY_LOG_LENGTH_Z; p++; break;
+        case 't': spec->length = YY_LOG_LENGTH_T; p++; break;
+        case 'L': spec->length = YY_LOG_LENGTH_LD; p++; break;
+        default: spec->length = YY_LOG_LENGTH_NONE; break;
+    }
+    spec->conversion = *p;
+    spec->end = p + 1;
+    if (spec->options_length > YY_LOG_SPEC_SIZE - 5) return false;
+    if (*p == '\0' || !strchr("diouxXcfFeEgGaApsn", *p)) return false;
+    if (*p == 's' && spec->length == YY_LOG_LENGTH_L) return false;
+    return true;
+}
+
+yy_inline long long _yy_log_signed_arg(yy_log_length length, va_list *args) {
+    switch (length) {
+        case YY_LOG_LENGTH_HH: return (signed char)va_arg(*args, int);
+        case YY_LOG_LENGTH_H: return (short)va_arg(*args, int);
+        case YY_LOG_LENGTH_L: return va_arg(*args, long);
+        case YY_LOG_LENGTH_LL: return va_arg(*args, long long);
+        case YY_LOG_LENGTH_J: return va_arg(*args, intmax_t);
+        case YY_LOG_LENGTH_Z: return (long long)va_arg(*args, size_t);
+        case YY_LOG_LENGTH_T: return va_arg(*args, ptrdiff_t);
+        default: return va_arg(*args, int);
+    }
+}
+
+yy_inline long long _yy_log_unsigned_arg(yy_log_length length, va_list *args) {
+    switch (length) {
+        case YY_LOG_LENGTH_HH: return (unsigned char)va_arg(*args, unsigned int);
+        case YY_LOG_LENGTH_H: return (unsigned short)va_arg(*args, unsigned int);
+        case YY_LOG_LENGTH_L: return va_arg(*args, unsigned long);
+        case YY_LOG_LENGTH_LL: return va_arg(*args, unsigned long long);
+        case YY_LOG_LENGTH_J: return va_arg(*args, uintmax_t);
+        case YY_LOG_LENGTH_Z: return va_arg(*args, size_t);
+        case YY_LOG_LENGTH_T: return (unsigned long long)va_arg(*args, ptrdiff_t);
+        default: return va_arg(*args, unsigned int);
+    }
+}
+
+/**
+ Copy the arguments of fmt to the record, without formatting them.
+ Returns false if the format is not supported.
+ */
+static bool _yy_log_record_args(yy_log_record_t *record, const char *fmt, va_list *args) {
+    yy_log_spec_t spec;
+    const char *p, *string;
+    long text_count = 0, length;
+    int i;
+    
+    record->arg_count = 0;
+    for (p = fmt; (p = strchr(p, '%')); ) {
+        p++;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        if (!_yy_log_parse_spec(p, &spec)) return false;
+        if (record->arg_count + spec.stars + 1 > YY_LOG_MAX_ARGS) return false;
+        for (i = 0; i < spec.stars; i++) {
+            record->args[record->arg_count++].i = va_arg(*args, int);
+        }
+        switch (spec.conversion) {
+            case 'd': case 'i':
+                record->args[record->arg_count++].i = _yy_log_signed_arg(spec.length, args);
+                break;
+            case 'o': case 'u': case 'x': case 'X':
+                record->args[record->arg_count++].i = _yy_log_unsigned_arg(spec.length, args);
+                break;
+            case 'c':
+                record->args[record->arg_count++].i = va_arg(*args, int);
+                break;
+            case 'p':
+                record->args[record->arg_count++].p = va_arg(*args, void *);
+                break;
+            case 'n':
+                (void)va_arg(*args, void *);
+                break;
+            case 's':
+                string = va_arg(*args, const char *);
+                if (string == NULL) {
+                    record->args[record->arg_count++].i = -1;
+                    break;
+                }
+                length = strnlen(string, YY_LOG_TEXT_SIZE - 1 - text_count);
+                memcpy(record->text + text_count, string, length);
+                record->text[text_count + length] = '\0';
+                record->args[record->arg_count++].i = text_count;
+                text_count = YY_MIN(text_count + length + 1, YY_LOG_TEXT_SIZE - 1);
+                break;
+            default:
+                if (spec.length == YY_LOG_LENGTH_LD) {
+                    record->args[record->arg_count++].d = (double)va_arg(*args, long double);
+                } else {
+                    record->args[record->arg_count++].d = va_arg(*args, double);
+                }
+                break;
+        }
+        p = spec.end;
+    }
+    return true;
+}
+
+static void _yy_log_async_push(yy_LOG_LEVEL level, char *fmt, va_list args) {
+    yy_log_ring_t *ring = _yy_log_current_ring;
+    yy_log_record_t *record;
+    unsigned long head;
+    va_list copy;
+    
+    if (ring == NULL) {
+        ring = calloc(1, sizeof(yy_log_ring_t));
+        if (ring == NULL) {
+            __atomic_add_fetch(&_yy_log_dropped_count, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        pthread_setspecific(_yy_log_ring_key, ring);
+        pthread_mutex_lock(&_yy_log_rings_lock);
+        ring->next = _yy_log_rings;
+        _yy_log_rings = ring;
+        pthread_mutex_unlock(&_yy_log_rings_lock);
+        _yy_log_current_ring = ring;
+    }
+    
+    head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= YY_LOG_RING_SIZE) {
+        __atomic_add_fetch(&_yy_log_dropped_count, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    record = ring->records + (head & (YY_LOG_RING_SIZE - 1));
+    record->level = level;
+    record->fmt = fmt;
+    va_copy(copy, args);
+    if (!_yy_log_record_args(record, fmt, &copy)) {
+        /* not supported, format it now */
+        record->fmt = NULL;
+        vsnprintf(record->text, YY_LOG_TEXT_SIZE, fmt, args);
+    }
+    va_end(copy);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+#define _YY_LOG_SNPRINTF(value) \
+    (spec.stars == 0 ? snprintf(out, size, format, value) : \
+     spec.stars == 1 ? snprintf(out, size, format, (int)args[0].i, value) : \
+     snprintf(out, size, format, (int)args[0].i, (int)args[1].i, value))
+
+/**
+ Format a record to _yy_log_message, the reverse of _yy_log_record_args().
+ */
+static void _yy_log_format_record(yy_log_record_t *record) {
+    yy_log_spec_t spec;
+    yy_log_arg_t *args = record->args;
+    char *out = _yy_log_message, *end = _yy_log_message + YY_LOG_MESSAGE_SIZE - 1;
+    char format[YY_LOG_SPEC_SIZE];
+    const char *p, *string;
+    long length, size;
+    int written;
+    
+    if (record->fmt == NULL) {
+        snprintf(_yy_log_message, YY_LOG_MESSAGE_SIZE, "%s", record->text);
+        return;
+    }
+    for (p = record->fmt; *p && out < end; ) {
+        if (*p != '%' || p[1] == '%') {
+            *out++ = *p;
+            p += (*p == '%') ? 2 : 1;
+            continue;
+        }
+        _yy_log_parse_spec(p + 1, &spec);
+        format[0] = '%';
+        memcpy(format + 1, spec.options, spec.options_length);
+        length = spec.options_length + 1;
+        if (strchr("diouxX", spec.conversion)) {
+            format[length++] = 'l';
+            format[length++] = 'l';
+        }
+        format[length++] = spec.conversion;
+        format[length] = '\0';
+        size = end - out + 1;
+        
+        switch (spec.conversion) {
+            case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+                written = _YY_LOG_SNPRINTF(args[spec.stars].i);
+                break;
+            case 'c':
+                written = _YY_LOG_SNPRINTF((int)args[spec.stars].i);
+                break;
+            case 'p':
+                written = _YY_LOG_SNPRINTF(args[spec.stars].p);
+                break;
+            case 'n':
+                written = 0;
+                break;
+            case 's':
+                string = args[spec.stars].i < 0 ? "(null)" : record->text + args[spec.stars].i;
+                written = _YY_LOG_SNPRINTF(string);
+                break;
+            default:
+                written = _YY_LOG_SNPRINTF(args[spec.stars].d);
+                break;
+        }
+        if (written > 0) out += YY_MIN(written, size - 1);
+        if (spec.conversion != 'n') args += spec.stars + 1;
+        p = spec.end;
+    }
+    *out = '\0';
+}
+
+/// Output the records of all the threads and free the rings of exited threads.
+static void _yy_log_async_drain() {
+    yy_log_ring_t *ring, **link;
+    yy_log_record_t *record;
+    unsigned long head, tail, dropped;
+    bool dead;
+    
+    pthread_mutex_lock(&_yy_log_drain_lock);
+    pthread_mutex_lock(&_yy_log_rings_lock);
+    ring = _yy_log_rings;
+    pthread_mutex_unlock(&_yy_log_rings_lock);
+    
+    /* rings are pushed at the front and only removed below, the walk is safe */
+    for (; ring; ring = ring->next) {
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        for (tail = ring->tail; tail != head; tail++) {
+            record = ring->records + (tail & (YY_LOG_RING_SIZE - 1));
+            _yy_log_format_record(record);
+            yy_log_async_output_func(record->level, _yy_log_message);
+            __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+        }
+    }
+    
+    pthread_mutex_lock(&_yy_log_rings_lock);
+    for (link = &_yy_log_rings; (ring = *link); ) {
+        dead = __atomic_load_n(&ring->dead, __ATOMIC_ACQUIRE);
+        if (dead && ring->tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+            *link = ring->next;
+            free(ring);
+        } else {
+            link = &ring->next;
+        }
+    }
+    pthread_mutex_unlock(&_yy_log_rings_lock);
+    
+    dropped = __atomic_load_n(&_yy_log_dropped_count, __ATOMIC_RELAXED);
+    if (dropped != _yy_log_reported_count) {
+        snprintf(_yy_log_message, YY_LOG_MESSAGE_SIZE, "%lu logs dropped (ring buffer full)",
+                 dropped - _yy_log_reported_count);
+        _yy_log_reported_count = dropped;
+        yy_log_async_output_func(yy_LOG_LEVEL_WARN, _yy_log_message);
+    }
+    pthread_mutex_unlock(&_yy_log_drain_lock);
+}
+
+static void * _yy_log_async_main(void *context) {
+    (void)context;
+    while (!__atomic_load_n(&_yy_log_async_stopping, __ATOMIC_ACQUIRE)) {
+        _yy_log_async_drain();
+        usleep(YY_LOG_POLL_INTERVAL);
+    }
+    return NULL;
+}
+
+bool yy_log_async_start() {
+    int error;
+    
+    pthread_once(&_yy_log_async_once, _yy_log_async_init);
+    pthread_mutex_lock(&_yy_log_control_lock);
+    if (__atomic_load_n(&_yy_log_async_running, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_unlock(&_yy_log_control_lock);
+        return true;
+    }
+    __atomic_store_n(&_yy_log_async_stopping, false, __ATOMIC_RELEASE);
+    error = pthread_create(&_yy_log_async_thread, NULL, _yy_log_async_main, NULL);
+    if (error == 0) {
+        __atomic_store_n(&_yy_log_async_running, true, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&_yy_log_control_lock);
+    if (error) {
+        yy_log_error("%s() attempt to create thread failed (%d)", __func__, error);
+        return false;
+    }
+    return true;
+}
+
+void yy_log_async_flush() {
+    pthread_once(&_yy_log_async_once, _yy_log_async_init);
+    _yy_log_async_drain();
+}
+
+void yy_log_async_stop() {
+    pthread_once(&_yy_log_async_once, _yy_log_async_init);
+    pthread_mutex_lock(&_yy_log_control_lock);
+    if (__atomic_load_n(&_yy_log_async_running, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&_yy_log_async_running, false, __ATOMIC_RELEASE);
+        __atomic_store_n(&_yy_log_async_stopping, true, __ATOMIC_RELEASE);
+        pthread_join(_yy_log_async_thread, NULL);
+    }
+    pthread_mutex_unlock(&_yy_log_control_lock);
+    _yy_log_async_drain();
+}
+
+unsigned long yy_log_async_get_dropped_count() {
+    return __atomic_load_n(&_yy_log_dropped_count, __ATOMIC_RELAXED);
+}
@@ -11,6 +11,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdbool.h>
 
 typedef enum {
     yy_LOG_LEVEL_ALL,
@@ -37,5 +38,58 @@ void yy_log_info(char *fmt, ...);
 void yy_log_warn(char *fmt, ...);
 void yy_log_error(char *fmt, ...);
 
+/*
+ Logs below yy_COMPILE_LOG_LEVEL are removed at compile time (the arguments
+ are not evaluated), the others check yy_log_level before the call, so a
+ disabled log costs a compare.
+ */
+#ifndef yy_COMPILE_LOG_LEVEL
+  #define yy_COMPILE_LOG_LEVEL yy_LOG_LEVEL_ALL
+#endif
+
+#define yy_LOG_ENABLED(level) ((level) >= yy_COMPILE_LOG_LEVEL && (level) >= yy_log_level)
+
+#define yy_log(level, ...) do { \
+    if (yy_LOG_ENABLED(level)) (yy_log)((level), __VA_ARGS__); \
+} while (0)
+
+#define yy_log_info(...) do { \
+    if (yy_LOG_ENABLED(yy_LOG_LEVEL_INFO)) (yy_log_info)(__VA_ARGS__); \
+} while (0)
+
+#define yy_log_warn(...) do { \
+    if (yy_LOG_ENABLED(yy_LOG_LEVEL_WARN)) (yy_log_warn)(__VA_ARGS__); \
+} while (0)
+
+#define yy_log_error(...) do { \
+    if (yy_LOG_ENABLED(yy_LOG_LEVEL_ERROR)) (yy_log_error)(__VA_ARGS__); \
+} while (0)
+
+
+/**
+ Asynchronous logging.
+ 
+ While started, a log is not formatted by the calling thread: the format
+ pointer (which must be a string literal) and the raw arguments are copied
+ to a ring buffer owned by the thread, without lock or allocation. The
+ strings of %s arguments are copied too (truncated if long). A background
+ thread formats the records and passes them to yy_log_async_output_func.
+ When a ring is full the log is dropped and counted.
+ */
+bool yy_log_async_start();
+/// Format and output all the recorded logs now.
+void yy_log_async_flush();
+/**
+ Stop the background thread and flush, logs are synchronous again.
+ A log made by another thread while stop runs may still be recorded after
+ the last flush, it is output by the next flush or start.
+ */
+void yy_log_async_stop();
+/// Number of logs dropped because a ring buffer was full.
+unsigned long yy_log_async_get_dropped_count();
+
+/// Output of the asynchronous logs, prints to stdout by default.
+extern void (*yy_log_async_output_func)(yy_LOG_LEVEL level, const char *message);
+
 
 #endif
@@ -7,8 +7,10 @@
 //
 
 #include "yy_map.h"
+#include "yy_map_private.h"
 #include "yy_log.h"
 #include "yy_base_private.h"
+#include "yy_file_private.h"
 
 #include <string.h>
 #include <limits.h>
@@ -68,14 +70,30 @@ yy_map_value_callback_t yy_map_object_value_callback = {
 };
 
 
-typedef struct _yy_map_node   yy_map_node_t;
+/// Number of keys hashed and prefetched together by the batch APIs.
+#define YY_MAP_PREFETCH_GROUP 16
 
-struct _yy_map_node {
-    const void *key;
-    const void *value;
-    unsigned long hash;
-    yy_map_node_t *next;
-};
+/// Minimum bucket count, the bucket count is always a power of 2.
+#define YY_MAP_MIN_BUCKET_COUNT 16
+
+/// Bits (or counters) set per key in the Bloom filter.
+#define YY_MAP_FILTER_HASH_COUNT 6
+
+/// A filter block is one cache line: 512 bits, or 128 4-bit counters.
+#define YY_MAP_FILTER_BLOCK_WORDS 8
+
+/// Buckets per filter block: 8 bits (or counters) per bucket, so at least 10 per key at the 3/4 load factor.
+#define YY_MAP_FILTER_BUCKETS_PER_BLOCK 64
+#define YY_MAP_FILTER_BUCKETS_PER_COUNTING_BLOCK 16
+
+/**
+ * Blocked Bloom filter: all the bits of a key are in one cache line.
+ */
+typedef struct _yy_map_filter {
+    yy_map_filter_type type;
+    long block_count;       ///< power of 2
+    uint64_t *blocks;       ///< block_count * YY_MAP_FILTER_BLOCK_WORDS, cache line aligned
+} yy_map_filter_t;
 
 struct _yy_map {
     long node_count;
@@ -83,10 +101,22 @@ struct _yy_map {
     yy_map_node_t **buckets;
     yy_map_key_callback_t key_callback;
     yy_map_value_callback_t value_callback;
+    yy_file_view_t *view;   ///< read-only strings mapped from file (buckets are unused)
+    yy_map_filter_t *filter;
+    long node_size;         ///< bytes allocated per node (see yy_map_private.h)
 };
 
 
 
+/**
+ * Bytes held by the map, reported to the registry (yy_registry.h).
+ */
+yy_inline long _yy_map_memory_size(yy_map_t *map) {
+    return sizeof(yy_map_t) + map->bucket_count * sizeof(yy_map_node_t *)
+        + (map->view ? 0 : map->node_count * map->node_size)
+        + (map->filter ? map->filter->block_count * YY_MAP_FILTER_BLOCK_WORDS * sizeof(uint64_t) : 0);
+}
+
 yy_inline yy_map_node_t * _yy_map_get_node(yy_map_t *map, yy_map_node_t **bucket, const void *key) {
     yy_map_node_t *node;
     
@@ -101,6 +131,203 @@ yy_inline yy_map_node_t * _yy_map_get_node(yy_map_t *map, yy_map_node_t **bucket
     return NULL;
 }
 
+/**
+ * Mix the bits of a user hash (see _yy_hash_mix).
+ */
+yy_inline unsigned long _yy_map_hash_mix(unsigned long hash) {
+    return (unsigned long)_yy_hash_mix(hash);
+}
+
+yy_inline unsigned long _yy_map_hash(yy_map_t *map, const void *key) {
+    return _yy_map_hash_mix(map->key_callback.hash(key));
+}
+
+yy_inline yy_map_node_t ** _yy_map_get_bucket(yy_map_t *map, unsigned long hash) {
+    return &map->buckets[hash & (map->bucket_count - 1)];
+}
+
+/**
+ * The block of a hash, selected with other bits than the bucket index.
+ */
+yy_inline uint64_t * _yy_map_filter_get_block(yy_map_filter_t *filter, unsigned long hash) {
+    uint64_t g = (uint64_t)hash * 0x9e3779b97f4a7c15ULL;
+    return filter->blocks + ((g >> 32) & (filter->block_count - 1)) * YY_MAP_FILTER_BLOCK_WORDS;
+}
+
+/**
+ * Positions in the block: double hashing, a + i * b.
+ */
+yy_inline void _yy_map_filter_get_probe(unsigned long hash, uint32_t *a, uint32_t *b) {
+    *a = (uint32_t)((uint64_t)hash * 0x9e3779b97f4a7c15ULL);
+    *b = (uint32_t)((uint64_t)hash >> 32) | 1;
+}
+
+yy_inline bool _yy_map_filter_may_contain(yy_map_filter_t *filter, unsigned long hash) {
+    uint64_t *block;
+    uint32_t a, b, pos;
+    int i;
+    
+    block = _yy_map_filter_get_block(filter, hash);
+    _yy_map_filter_get_probe(hash, &a, &b);
+    if (filter->type == YY_MAP_FILTER_COUNTING_BLOOM) {
+        for (i = 0; i < YY_MAP_FILTER_HASH_COUNT; i++) {
+            pos = (a + i * b) & 127;
+            if (((block[pos >> 4] >> ((pos & 15) * 4)) & 0xF) == 0) return false;
+        }
+    } else {
+        for (i = 0; i < YY_MAP_FILTER_HASH_COUNT; i++) {
+            pos = (a + i * b) & 511;
+            if ((block[pos >> 6] & (1ULL << (pos & 63))) == 0) return false;
+        }
+    }
+    return true;
+}
+
+yy_inline void _yy_map_filter_add(yy_map_filter_t *filter, unsigned long hash) {
+    uint64_t *block;
+    uint32_t a, b, pos, shift;
+    int i;
+    
+    block = _yy_map_filter_get_block(filter, hash);
+    _yy_map_filter_get_probe(hash, &a, &b);
+    if (filter->type == YY_MAP_FILTER_COUNTING_BLOOM) {
+        for (i = 0; i < YY_MAP_FILTER_HASH_COUNT; i++) {
+            pos = (a + i * b) & 127;
+            shift = (pos & 15) * 4;
+            /* a saturated counter sticks, it can no longer be decremented safely */
+            if (((block[pos >> 4] >> shift) & 0xF) != 0xF) block[pos >> 4] += 1ULL << shift;
+        }
+    } else {
+        for (i = 0; i < YY_MAP_FILTER_HASH_COUNT; i++) {
+            pos = (a + i * b) & 511;
+            block[pos >> 6] |= 1ULL << (pos & 63);
+        }
+    }
+}
+
+/**
+ * Only the counting filter supports removal, the bits of a plain filter are
+ * cleared when it is rebuilt (resize or clear).
+ */
+yy_inline void _yy_map_filter_remove(yy_map_filter_t *filter, unsigned long hash) {
+    uint64_t *block, counter;
+    uint32_t a, b, pos, shift;
+    int i;
+    
+    if (filter->type != YY_MAP_FILTER_COUNTING_BLOOM) return;
+    block = _yy_map_filter_get_block(filter, hash);
+    _yy_map_filter_get_probe(hash, &a, &b);
+    for (i = 0; i < YY_MAP_FILTER_HASH_COUNT; i++) {
+        pos = (a + i * b) & 127;
+        shift = (pos & 15) * 4;
+        counter = (block[pos >> 4] >> shift) & 0xF;
+        if (counter != 0 && counter != 0xF) block[pos >> 4] -= 1ULL << shift;
+    }
+}
+
+static void _yy_map_filter_free(yy_map_filter_t *filter) {
+    if (filter == NULL) return;
+    free(filter->blocks);
+    free(filter);
+}
+
+/**
+ * Create a filter sized for bucket_count and add the keys of the map.
+ */
+static yy_map_filter_t * _yy_map_filter_create(yy_map_t *map, yy_map_filter_type type, long bucket_count) {
+    yy_map_filter_t *filter;
+    yy_map_node_t *node;
+    void *blocks;
+    long i, size;
+    
+    filter = calloc(1, sizeof(yy_map_filter_t));
+    if (filter == NULL) {
+        yy_log_error("yy_map_t(%p):%s() attempt to allocate %ld bytes failed",
+                     map, __func__, sizeof(yy_map_filter_t));
+        return NULL;
+    }
+    filter->type = type;
+    filter->block_count = bucket_count / (type == YY_MAP_FILTER_COUNTING_BLOOM
+                                          ? YY_MAP_FILTER_BUCKETS_PER_COUNTING_BLOCK
+                                          : YY_MAP_FILTER_BUCKETS_PER_BLOCK);
+    if (filter->block_count < 1) filter->block_count = 1;
+    size = filter->block_count * YY_MAP_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+    if (posix_memalign(&blocks, YY_MAP_FILTER_BLOCK_WORDS * sizeof(uint64_t), size) != 0) {
+        yy_log_error("yy_map_t(%p):%s() attempt to allocate %ld bytes failed",
+                     map, __func__, size);
+        free(filter);
+        return NULL;
+    }
+    memset(blocks, 0, size);
+    filter->blocks = blocks;
+    for (i = 0; i < map->bucket_count; i++) {
+        for (node = map->buckets[i]; node; node = node->next) {
+            _yy_map_filter_add(filter, node->hash);
+        }
+    }
+    return filter;
+}
+
+/**
+ * Resize the filter with the buckets. If that fails the filter is dropped,
+ * lookups are still correct without it.
+ */
+static void _yy_map_filter_rebuild(yy_map_t *map) {
+    yy_map_filter_t *filter;
+    
+    if (map->filter == NULL) return;
+    filter = _yy_map_filter_create(map, map->filter->type, map->bucket_count);
+    _yy_map_filter_free(map->filter);
+    map->filter = filter;
+}
+
+/**
+ * Reverse the bits of the cursor (used by scan).
+ */
+yy_inline unsigned long _yy_map_reverse_bits(unsigned long v) {
+    unsigned long s = sizeof(v) * CHAR_BIT;
+    unsigned long mask = ~0UL;
+    while ((s >>= 1) > 0) {
+        mask ^= (mask << s);
+        v = ((v >> s) & mask) | ((v << s) & ~mask);
+    }
+    return v;
+}
+
+/**
+ * Maps mapped from file cannot be modified.
+ */
+yy_inline bool _yy_map_validate_mutable(yy_map_t *map, const char *func) {
+    if (map->view) {
+        yy_log_error("yy_map_t(%p):%s() map is read-only (mapped from file)",
+                     map, func);
+        return false;
+    }
+    return true;
+}
+
+yy_inline const yy_file_map_entry_t * _yy_map_view_entries(yy_map_t *map) {
+    return map->view->table;
+}
+
+/**
+ * Find a key in the index of a map mapped from file.
+ */
+static const yy_file_map_entry_t * _yy_map_view_find(yy_map_t *map, const void *key, uint64_t hash) {
+    const yy_file_map_entry_t *entry;
+    uint64_t mask, i;
+    
+    mask = map->view->header->slot_count - 1;
+    for (i = hash & mask; map->view->slots[i] != 0; i = (i + 1) & mask) {
+        entry = _yy_map_view_entries(map) + map->view->slots[i] - 1;
+        if (entry->hash == hash
+            && map->key_callback.equal(_yy_file_view_string(map->view, entry->key), key)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
 yy_inline void _yy_map_resize(yy_map_t *map, long new_bucket_count) {
     yy_map_node_t **new_buckets, *node, *next_node, *new_node;
     long i, new_bucket_index;
@@ -117,7 +344,7 @@ yy_inline void _yy_map_resize(yy_map_t *map, long new_bucket_count) {
         while (node) {
             next_node = node->next;
             node->next = NULL;
-            new_bucket_index = node->hash % new_bucket_count;
+            new_bucket_index = node->hash & (new_bucket_count - 1);
             new_node = new_buckets[new_bucket_index];
             if (!new_node) {
                 new_buckets[new_bucket_index] = node;
@@ -131,10 +358,13 @@ yy_inline void _yy_map_resize(yy_map_t *map, long new_bucket_count) {
     free(map->buckets);
     map->buckets = new_buckets;
     map->bucket_count = new_bucket_count;
+    _yy_map_filter_rebuild(map);
+    YY_REGISTRY_SET_BYTES(map, _yy_map_memory_size(map));
 }
 
 static void _yy_map_dealloc(yy_map_t *map) {
     yy_map_clear(map);
+    _yy_map_filter_free(map->filter);
     free(map->buckets);
     yy_dealloc(map);
 }
@@ -146,6 +376,13 @@ yy_map_t * yy_map_create() {
 yy_map_t * yy_map_create_with_options(long                          capacity,
                                       const yy_map_key_callback_t   *key_callback,
                                       const yy_map_value_callback_t *value_callback) {
+    return _yy_map_create_with_node_size(capacity, key_callback, value_callback, sizeof(yy_map_node_t));
+}
+
+yy_map_t * _yy_map_create_with_node_size(long capacity,
+                                         const yy_map_key_callback_t *key_callback,
+                                         const yy_map_value_callback_t *value_callback,
+                                         long node_size) {
     yy_map_t *map;
     
     if (capacity < 0) {
@@ -153,9 +390,19 @@ yy_map_t * yy_map_create_with_options(long                          capacity,
                      __func__, capacity);
         return NULL;
     }
-    if (capacity < 13) capacity = 13; // min buckets count.
-    
-    /// TODO optimize capacity
+    if (node_size < (long)sizeof(yy_map_node_t)) {
+        yy_log_error("%s() node_size(%ld) cannot be less than %ld",
+                     __func__, node_size, (long)sizeof(yy_map_node_t));
+        return NULL;
+    }
+    if (capacity < YY_MAP_MIN_BUCKET_COUNT) {
+        capacity = YY_MAP_MIN_BUCKET_COUNT;
+    } else if (capacity > (LONG_MAX >> 2)) {
+        capacity = (LONG_MAX >> 2) + 1;
+    } else if (capacity & (capacity - 1)) {
+        while (capacity & (capacity - 1)) capacity &= capacity - 1;
+        capacity <<= 1;
+    }
     
     map = yy_alloc(yy_map_t, _yy_map_dealloc);
     
@@ -175,11 +422,13 @@ yy_map_t * yy_map_create_with_options(long                          capacity,
     
     map->node_count = 0;
     map->bucket_count = capacity;
+    map->node_size = node_size;
     if (key_callback) map->key_callback = *key_callback;
     if (value_callback) map->value_callback = *value_callback;
     if (map->key_callback.hash == NULL) {
         map->key_callback.hash = _yy_map_hash_callback_default;
     }
+    YY_REGISTRY_SET_BYTES(map, _yy_map_memory_size(map));
     return map;
 }
 
@@ -187,20 +436,37 @@ long yy_map_count(yy_map_t *map) {
     return map->node_count;
 }
 
+/**
+ * Find the node of key (hash is the mixed hash), checking the filter first.
+ */
+yy_inline yy_map_node_t * _yy_map_get_node_with_hash(yy_map_t *map, const void *key, unsigned long hash) {
+    if (map->filter && !_yy_map_filter_may_contain(map->filter, hash)) return NULL;
+    return _yy_map_get_node(map, _yy_map_get_bucket(map, hash), key);
+}
+
 bool yy_map_contains_key(yy_map_t *map, const void *key) {
-    yy_map_node_t **bucket, *node;
-    unsigned long bucket_index;
+    unsigned long hash;
     
-    bucket_index = map->key_callback.hash(key) % map->bucket_count;
-    bucket = &(map->buckets[bucket_index]);
-    node = _yy_map_get_node(map, bucket, key);
-    return node != NULL;
+    hash = _yy_map_hash(map, key);
+    if (map->view) return _yy_map_view_find(map, key, hash) != NULL;
+    return _yy_map_get_node_with_hash(map, key, hash) != NULL;
 }
 
 bool yy_map_contains_value(yy_map_t *map, const void *value) {
     long i;
     yy_map_node_t **bucket, *node;
+    const void *node_value;
     
+    if (map->view) {
+        for (i = 0; i < map->node_count; i++) {
+            node_value = _yy_file_view_string(map->view, _yy_map_view_entries(map)[i].value);
+            if (node_value == value
+                || (node_value && value && map->value_callback.equal(node_value, value))) {
+                return true;
+            }
+        }
+        return false;
+    }
     for (i = 0; i < map->bucket_count; i++) {
         bucket = &map->buckets[i];
         node = *bucket;
@@ -216,35 +482,143 @@ bool yy_map_contains_value(yy_map_t *map, const void *value) {
 }
 
 const void * yy_map_get(yy_map_t *map, const void *key) {
-    yy_map_node_t **bucket, *node;
-    unsigned long bucket_index;
+    return yy_map_get_with_hash(map, key, map->key_callback.hash(key));
+}
+
+unsigned long yy_map_hash_key(yy_map_t *map, const void *key) {
+    return map->key_callback.hash(key);
+}
+
+const void * yy_map_get_with_hash(yy_map_t *map, const void *key, unsigned long hash) {
+    yy_map_node_t *node;
+    const yy_file_map_entry_t *entry;
     
-    bucket_index = map->key_callback.hash(key) % map->bucket_count;
-    bucket = &(map->buckets[bucket_index]);
-    node = _yy_map_get_node(map, bucket, key);
+    hash = _yy_map_hash_mix(hash);
+    if (map->view) {
+        entry = _yy_map_view_find(map, key, hash);
+        return entry ? _yy_file_view_string(map->view, entry->value) : NULL;
+    }
+    node = _yy_map_get_node_with_hash(map, key, hash);
     if (node) return node->value;
     return NULL;
 }
 
-bool yy_map_set(yy_map_t *map, const void *key, const void *value) {
+long yy_map_get_many(yy_map_t *map, const void **keys, long count, const void **values) {
+    unsigned long hashes[YY_MAP_PREFETCH_GROUP];
+    yy_map_node_t **buckets[YY_MAP_PREFETCH_GROUP];
+    yy_map_node_t *nodes[YY_MAP_PREFETCH_GROUP], *node;
+    const void *key;
+    long i, j, group, found;
+    
+    if (count < 0) {
+        yy_log_error("yy_map_t(%p):%s() count(%ld) cannot be less than zero",
+                     map, __func__, count);
+        return 0;
+    }
+    if (keys == NULL || values == NULL) return 0;
+    
+    found = 0;
+    if (map->view) {
+        for (i = 0; i < count; i++) {
+            values[i] = yy_map_get(map, keys[i]);
+            if (values[i] || yy_map_contains_key(map, keys[i])) found++;
+        }
+        return found;
+    }
+    for (i = 0; i < count; i += group) {
+        group = YY_MIN(count - i, YY_MAP_PREFETCH_GROUP);
+        
+        /* stage 1: hash the whole group and prefetch its buckets (the filtered out keys are skipped) */
+        for (j = 0; j < group; j++) {
+            hashes[j] = _yy_map_hash(map, keys[i + j]);
+            if (map->filter && !_yy_map_filter_may_contain(map->filter, hashes[j])) {
+                buckets[j] = NULL;
+                continue;
+            }
+            buckets[j] = _yy_map_get_bucket(map, hashes[j]);
+            YY_PREFETCH(buckets[j]);
+        }
+        
+        /* stage 2: load the bucket heads and prefetch the first nodes */
+        for (j = 0; j < group; j++) {
+            nodes[j] = buckets[j] ? *buckets[j] : NULL;
+            if (nodes[j]) YY_PREFETCH(nodes[j]);
+        }
+        
+        /* stage 3: resolve, by now the nodes should be in cache */
+        for (j = 0; j < group; j++) {
+            node = nodes[j];
+            key = keys[i + j];
+            while (node) {
+                if (node->key == key
+                    || (node->hash == hashes[j]
+                        && map->key_callback.equal
+                        && map->key_callback.equal(node->key, key))) {
+                    break;
+                }
+                node = node->next;
+            }
+            if (node) {
+                values[i + j] = node->value;
+                found++;
+            } else {
+                values[i + j] = NULL;
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * Grow the bucket array once so that it can hold node_count nodes
+ * without crossing the load factor.
+ */
+yy_inline void _yy_map_reserve(yy_map_t *map, long node_count) {
+    long bucket_count;
+    
+    bucket_count = map->bucket_count;
+    while (node_count > bucket_count * 3.0f / 4.0f && bucket_count < (LONG_MAX >> 2)) {
+        bucket_count <<= 1;
+    }
+    if (bucket_count != map->bucket_count) {
+        _yy_map_resize(map, bucket_count);
+    }
+}
+
+/**
+ * Set a key-value pair (hash is the mixed hash), returns its node or NULL on failure.
+ * With `transfer` the map adopts the references of key and value instead of
+ * retaining them: if the key is already present, the node keeps its key and
+ * the one passed in is released, a value equal to the stored one is released too.
+ */
+static yy_map_node_t * _yy_map_set_node_with_hash(yy_map_t *map, const void *key, unsigned long hash,
+                                                  const void *value, bool transfer, bool *added) {
     yy_map_node_t **bucket, *node, *cur_node;
-    unsigned long bucket_index, hash;
     
-    hash = map->key_callback.hash(key);
-    bucket_index = hash % map->bucket_count;
-    bucket = &(map->buckets[bucket_index]);
-    node = _yy_map_get_node(map, bucket, key);
+    *added = false;
+    bucket = _yy_map_get_bucket(map, hash);
+    if (map->filter && !_yy_map_filter_may_contain(map->filter, hash)) node = NULL;
+    else node = _yy_map_get_node(map, bucket, key);
     
     if (node) {
-        if (map->value_callback.retain) value = map->value_callback.retain(value);
+        if (transfer) {
+            /* both references are ours, even when they are the stored pointers */
+            if (map->key_callback.release) map->key_callback.release(key);
+            if (value == node->value) {
+                if (map->value_callback.release) map->value_callback.release(value);
+                return node;
+            }
+        } else if (map->value_callback.retain) {
+            value = map->value_callback.retain(value);
+        }
         if (map->value_callback.release) map->value_callback.release(node->value);
         node->value = value;
     } else {
-        node = calloc(1, sizeof(yy_map_node_t));
+        node = calloc(1, map->node_size);
         if (node == NULL) {
             yy_log_error("yy_map_t:%s() attempt to allocate %ld bytes failed",
-                         __func__, sizeof(yy_map_node_t));
-            return false;
+                         __func__, map->node_size);
+            return NULL;
         }
         
         if (*bucket) {
@@ -255,44 +629,150 @@ bool yy_map_set(yy_map_t *map, const void *key, const void *value) {
             *bucket = node;
         }
         
-        if (map->key_callback.retain) node->key = map->key_callback.retain(key);
+        if (map->key_callback.retain && !transfer) node->key = map->key_callback.retain(key);
         else node->key = key;
-        if (map->value_callback.retain) value = map->value_callback.retain(value);
+        if (map->value_callback.retain && !transfer) value = map->value_callback.retain(value);
         node->value = value;
         node->hash = hash;
         map->node_count++;
+        *added = true;
+        if (map->filter) _yy_map_filter_add(map->filter, hash);
+        YY_REGISTRY_SET_BYTES(map, _yy_map_memory_size(map));
+    }
+    
+    if (map->node_count > map->bucket_count * 3.0f / 4.0f && map->bucket_count < (LONG_MAX >> 2)) {
+        _yy_map_resize(map, map->bucket_count << 1);
+    }
+    return node;
+}
+
+yy_inline bool _yy_map_set_with_hash(yy_map_t *map, const void *key, unsigned long hash, const void *value, bool transfer) {
+    bool added;
+    return _yy_map_set_node_with_hash(map, key, hash, value, transfer, &added) != NULL;
+}
+
+bool yy_map_set(yy_map_t *map, const void *key, const void *value) {
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    return _yy_map_set_with_hash(map, key, _yy_map_hash(map, key), value, false);
+}
+
+bool yy_map_set_with_hash(yy_map_t *map, const void *key, unsigned long hash, const void *value) {
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    return _yy_map_set_with_hash(map, key, _yy_map_hash_mix(hash), value, false);
+}
+
+bool yy_map_set_transfer(yy_map_t *map, const void *key, const void *value) {
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    return _yy_map_set_with_hash(map, key, _yy_map_hash(map, key), value, true);
+}
+
+bool yy_map_set_many(yy_map_t *map, const void **keys, long count, const void **values) {
+    unsigned long hashes[YY_MAP_PREFETCH_GROUP];
+    yy_map_node_t **buckets[YY_MAP_PREFETCH_GROUP];
+    long i, j, group;
+    
+    if (count < 0) {
+        yy_log_error("yy_map_t(%p):%s() count(%ld) cannot be less than zero",
+                     map, __func__, count);
+        return false;
     }
+    if (count == 0) return true;
+    if (keys == NULL || values == NULL) return false;
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    
+    /* grow once up front, so the prefetched buckets stay valid for the batch */
+    _yy_map_reserve(map, map->node_count + count);
     
-    ///TODO optimize resize!!!
-    if (map->node_count > map->bucket_count * 3.0f / 4.0f) {
-        _yy_map_resize(map, map->bucket_count * 2 + 1);
+    for (i = 0; i < count; i += group) {
+        group = YY_MIN(count - i, YY_MAP_PREFETCH_GROUP);
+        for (j = 0; j < group; j++) {
+            hashes[j] = _yy_map_hash(map, keys[i + j]);
+            buckets[j] = _yy_map_get_bucket(map, hashes[j]);
+            YY_PREFETCH(buckets[j]);
+        }
+        for (j = 0; j < group; j++) {
+            if (*buckets[j]) YY_PREFETCH(*buckets[j]);
+        }
+        for (j = 0; j < group; j++) {
+            if (!_yy_map_set_with_hash(map, keys[i + j], hashes[j], values[i + j], false)) {
+                return false;
+            }
+        }
     }
     return true;
 }
 
 bool yy_map_set_all(yy_map_t *map, yy_map_t *add) {
     long i;
+    bool same_hash;
     yy_map_node_t **bucket, *node;
+    const yy_file_map_entry_t *entry;
+    const void *key;
     
     if (add == NULL) return false;
+    if (add == map) return true;
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    
+    _yy_map_reserve(map, map->node_count + add->node_count);
+    same_hash = map->key_callback.hash == add->key_callback.hash;
+    if (add->view) {
+        for (i = 0; i < add->node_count; i++) {
+            entry = _yy_map_view_entries(add) + i;
+            key = _yy_file_view_string(add->view, entry->key);
+            _yy_map_set_with_hash(map,
+                                  key,
+                                  same_hash ? (unsigned long)entry->hash : _yy_map_hash(map, key),
+                                  _yy_file_view_string(add->view, entry->value),
+                                  false);
+        }
+        return true;
+    }
     for (i = 0; i < add->bucket_count; i++) {
         bucket = &add->buckets[i];
         if (!*bucket) continue;
         node = *bucket;
         while (node) {
-            yy_map_set(map, node->key, node->value);
+            _yy_map_set_with_hash(map,
+                                  node->key,
+                                  same_hash ? node->hash : _yy_map_hash(map, node->key),
+                                  node->value,
+                                  false);
             node = node->next;
         }
     }
     return true;
 }
 
-bool yy_map_remove(yy_map_t *map, const void *key) {
+/**
+ * Unlink and free a node (prev_node is the node before it in bucket, or NULL).
+ * If `value` is not NULL the value is not released but returned to the caller.
+ */
+static void _yy_map_free_node(yy_map_t *map, yy_map_node_t **bucket, yy_map_node_t *prev_node,
+                              yy_map_node_t *node, const void **value) {
+    if (map->key_callback.release) map->key_callback.release(node->key);
+    if (value) *value = node->value;
+    else if (map->value_callback.release) map->value_callback.release(node->value);
+    if (prev_node == NULL) *bucket = node->next;
+    else prev_node->next = node->next;
+    if (map->filter) _yy_map_filter_remove(map->filter, node->hash);
+    free(node);
+    map->node_count--;
+    YY_REGISTRY_SET_BYTES(map, _yy_map_memory_size(map));
+    
+    if (map->bucket_count > YY_MAP_MIN_BUCKET_COUNT && map->node_count < map->bucket_count / 8) {
+        _yy_map_resize(map, map->bucket_count >> 1);
+    }
+}
+
+/**
+ * Remove a key (hash is the mixed hash).
+ * If `value` is not NULL the value is not released but returned to the caller.
+ */
+static bool _yy_map_remove_with_hash(yy_map_t *map, const void *key, unsigned long hash, const void **value) {
     yy_map_node_t **bucket, *node, *prev_node;
-    unsigned long bucket_index;
     
-    bucket_index = map->key_callback.hash(key) % map->bucket_count;
-    bucket = &map->buckets[bucket_index];
+    if (map->filter && !_yy_map_filter_may_contain(map->filter, hash)) return false;
+    bucket = _yy_map_get_bucket(map, hash);
     
     node = *bucket;
     prev_node = NULL;
@@ -306,18 +786,63 @@ bool yy_map_remove(yy_map_t *map, const void *key) {
     }
     if (node == NULL) return false;
     
-    if (map->key_callback.release) map->key_callback.release(node->key);
-    if (map->value_callback.release) map->value_callback.release(node->value);
-    if (prev_node == NULL) *bucket = node->next;
-    else prev_node->next = node->next;
-    free(node);
+    _yy_map_free_node(map, bucket, prev_node, node, value);
     return true;
 }
 
+bool yy_map_remove(yy_map_t *map, const void *key) {
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    return _yy_map_remove_with_hash(map, key, _yy_map_hash(map, key), NULL);
+}
+
+bool yy_map_remove_with_hash(yy_map_t *map, const void *key, unsigned long hash) {
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    return _yy_map_remove_with_hash(map, key, _yy_map_hash_mix(hash), NULL);
+}
+
+bool yy_map_take(yy_map_t *map, const void *key, const void **value) {
+    const void *taken;
+    
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    if (!_yy_map_remove_with_hash(map, key, _yy_map_hash(map, key), &taken)) return false;
+    if (value) *value = taken;
+    else if (map->value_callback.release) map->value_callback.release(taken);
+    return true;
+}
+
+yy_map_node_t * _yy_map_find_node(yy_map_t *map, const void *key) {
+    if (map->view) return NULL;
+    return _yy_map_get_node_with_hash(map, key, _yy_map_hash(map, key));
+}
+
+yy_map_node_t * _yy_map_set_node(yy_map_t *map, const void *key, const void *value, bool *added) {
+    if (!_yy_map_validate_mutable(map, __func__)) return NULL;
+    return _yy_map_set_node_with_hash(map, key, _yy_map_hash(map, key), value, false, added);
+}
+
+void _yy_map_remove_node(yy_map_t *map, yy_map_node_t *node) {
+    yy_map_node_t **bucket, *prev_node;
+    
+    bucket = _yy_map_get_bucket(map, node->hash);
+    prev_node = NULL;
+    if (*bucket != node) {
+        prev_node = *bucket;
+        while (prev_node->next != node) prev_node = prev_node->next;
+    }
+    _yy_map_free_node(map, bucket, prev_node, node, NULL);
+}
+
 bool yy_map_clear(yy_map_t *map) {
     long i;
     yy_map_node_t **bucket, *node, *next_node;
     
+    if (map->view) {
+        /* drop the mapping, the map becomes an ordinary empty map */
+        _yy_file_view_release(map->view);
+        map->view = NULL;
+        map->node_count = 0;
+        return true;
+    }
     for (i = 0; i < map->bucket_count; i++) {
         bucket = &map->buckets[i];
         node = *bucket;
@@ -330,6 +855,11 @@ bool yy_map_clear(yy_map_t *map) {
         }
         *bucket = NULL;
     }
+    map->node_count = 0;
+    if (map->filter) {
+        memset(map->filter->blocks, 0, map->filter->block_count * YY_MAP_FILTER_BLOCK_WORDS * sizeof(uint64_t));
+    }
+    YY_REGISTRY_SET_BYTES(map, _yy_map_memory_size(map));
     return true;
 }
 
@@ -338,6 +868,12 @@ bool yy_map_get_all_keys(yy_map_t *map, const void **keys) {
     yy_map_node_t **bucket, *node;
     
     if (keys == NULL) return false;
+    if (map->view) {
+        for (i = 0; i < map->node_count; i++) {
+            keys[i] = _yy_file_view_string(map->view, _yy_map_view_entries(map)[i].key);
+        }
+        return true;
+    }
     for (i = 0; i < map->bucket_count; i++) {
         bucket = &map->buckets[i];
         node = *bucket;
@@ -355,6 +891,14 @@ bool yy_map_foreach(yy_map_t *map, yy_map_foreach_func func, void *context) {
     yy_map_node_t **bucket, *node;
     
     if (func == NULL) return false;
+    if (map->view) {
+        for (i = 0; i < map->node_count; i++) {
+            func(_yy_file_view_string(map->view, _yy_map_view_entries(map)[i].key),
+                 _yy_file_view_string(map->view, _yy_map_view_entries(map)[i].value),
+                 context);
+        }
+        return true;
+    }
     for (i = 0; i < map->bucket_count; i++) {
         bucket = &map->buckets[i];
         node = *bucket;
@@ -377,6 +921,12 @@ yy_array_t *yy_map_create_key_array(yy_map_t *map) {
     callback.equal = map->key_callback.equal;
     array = yy_array_create_with_options(0, &callback);
     if (array == NULL) return NULL;
+    if (map->view) {
+        for (i = 0; i < map->node_count; i++) {
+            yy_array_append(array, _yy_file_view_string(map->view, _yy_map_view_entries(map)[i].key));
+        }
+        return array;
+    }
     for (i = 0; i < map->bucket_count; i++) {
         bucket = &map->buckets[i];
         node = *bucket;
@@ -387,3 +937,255 @@ yy_array_t *yy_map_create_key_array(yy_map_t *map) {
     }
     return array;
 }
+
+bool yy_map_set_filter(yy_map_t *map, yy_map_filter_type type) {
+    yy_map_filter_t *filter;
+    
+    if (!_yy_map_validate_mutable(map, __func__)) return false;
+    if (type != YY_MAP_FILTER_NONE && type != YY_MAP_FILTER_BLOOM && type != YY_MAP_FILTER_COUNTING_BLOOM) {
+        yy_log_error("yy_map_t(%p):%s() invalid filter type(%d)", map, __func__, (int)type);
+        return false;
+    }
+    if (type == YY_MAP_FILTER_NONE) {
+        filter = NULL;
+    } else {
+        filter = _yy_map_filter_create(map, type, map->bucket_count);
+        if (filter == NULL) return false;
+    }
+    _yy_map_filter_free(map->filter);
+    map->filter = filter;
+    YY_REGISTRY_SET_BYTES(map, _yy_map_memory_size(map));
+    return true;
+}
+
+yy_map_filter_type yy_map_get_filter(yy_map_t *map) {
+    return map->filter ? map->filter->type : YY_MAP_FILTER_NONE;
+}
+
+double yy_map_get_filter_false_positive_rate(yy_map_t *map) {
+    yy_map_filter_t *filter;
+    uint64_t *block, word;
+    double rate, fill, block_rate;
+    long i, j, k, set;
+    
+    filter = map->filter;
+    if (filter == NULL) return 1;
+    rate = 0;
+    for (i = 0; i < filter->block_count; i++) {
+        block = filter->blocks + i * YY_MAP_FILTER_BLOCK_WORDS;
+        set = 0;
+        for (j = 0; j < YY_MAP_FILTER_BLOCK_WORDS; j++) {
+            word = block[j];
+            if (filter->type == YY_MAP_FILTER_COUNTING_BLOOM) {
+                for (k = 0; k < 16; k++) set += ((word >> (k * 4)) & 0xF) != 0;
+            } else {
+                set += __builtin_popcountll(word);
+            }
+        }
+        
+        /* a miss hashed to this block passes if all its positions are set */
+        fill = (double)set / (filter->type == YY_MAP_FILTER_COUNTING_BLOOM ? 128 : 512);
+        block_rate = 1;
+        for (k = 0; k < YY_MAP_FILTER_HASH_COUNT; k++) block_rate *= fill;
+        rate += block_rate;
+    }
+    return rate / filter->block_count;
+}
+
+long yy_map_scan(yy_map_t *map, unsigned long *cursor, long batch, const void **keys, const void **values) {
+    unsigned long v, mask;
+    long count, length, empty_visits;
+    yy_map_node_t *node;
+    
+    if (cursor == NULL || keys == NULL) return -1;
+    if (batch <= 0) {
+        yy_log_error("yy_map_t(%p):%s() batch(%ld) must be greater than zero",
+                     map, __func__, batch);
+        return -1;
+    }
+    if (map->view) {
+        /* a mapped map is never modified, the cursor is just an entry index */
+        for (count = 0; count < batch && *cursor < (unsigned long)map->node_count; count++, (*cursor)++) {
+            keys[count] = _yy_file_view_string(map->view, _yy_map_view_entries(map)[*cursor].key);
+            if (values) values[count] = _yy_file_view_string(map->view, _yy_map_view_entries(map)[*cursor].value);
+        }
+        if (*cursor >= (unsigned long)map->node_count) *cursor = 0;
+        return count;
+    }
+    
+    /*
+     Buckets are visited in reverse binary order of their index, so the high
+     bits of the cursor are incremented first. When the bucket count grows or
+     shrinks between two calls (it is always a power of 2), every bucket that
+     was already visited maps to buckets whose reversed index is still lower
+     than the cursor, so nothing present for the whole scan is skipped.
+     Keys may be returned more than once after a shrink.
+     
+     A bucket is never split across calls: a chain only has a position while
+     it is not modified, so a removal between two calls could hide a key.
+     */
+    v = *cursor;
+    mask = map->bucket_count - 1;
+    count = 0;
+    empty_visits = batch < LONG_MAX / 10 ? batch * 10 : LONG_MAX;
+    do {
+        node = map->buckets[v & mask];
+        if (node == NULL) {
+            empty_visits--;
+        } else {
+            length = 0;
+            while (node) {
+                length++;
+                node = node->next;
+            }
+            if (count + length > batch) {
+                /* the caller needs a larger batch for this bucket alone */
+                if (count == 0) return -length;
+                break;
+            }
+            for (node = map->buckets[v & mask]; node; node = node->next, count++) {
+                keys[count] = node->key;
+                if (values) values[count] = node->value;
+            }
+        }
+        
+        v |= ~mask;
+        v = _yy_map_reverse_bits(v);
+        v++;
+        v = _yy_map_reverse_bits(v);
+    } while (v != 0 && count < batch && empty_visits > 0);
+    
+    *cursor = v;
+    return count;
+}
+
+typedef struct {
+    yy_map_t *map;
+    yy_file_map_entry_t *entries;
+    long count;
+    uint64_t blob_size;
+    FILE *fp;
+    bool ok;
+} _yy_map_write_context;
+
+static void _yy_map_write_measure(const void *key, const void *value, void *context) {
+    _yy_map_write_context *ctx = context;
+    yy_file_map_entry_t *entry = ctx->entries + ctx->count++;
+    
+    entry->hash = _yy_map_hash(ctx->map, key);
+    entry->key = ctx->blob_size;
+    ctx->blob_size += strlen(key) + 1;
+    if (value) {
+        entry->value = ctx->blob_size;
+        ctx->blob_size += strlen(value) + 1;
+    } else {
+        entry->value = YY_FILE_NULL_OFFSET;
+    }
+}
+
+static void _yy_map_write_strings(const void *key, const void *value, void *context) {
+    _yy_map_write_context *ctx = context;
+    
+    ctx->ok = ctx->ok && _yy_file_write(ctx->fp, key, strlen(key) + 1);
+    if (value) ctx->ok = ctx->ok && _yy_file_write(ctx->fp, value, strlen(value) + 1);
+}
+
+static void _yy_map_write_check_null(const void *key, const void *value, void *context) {
+    (void)key;
+    if (value) *(bool *)context = false;
+}
+
+bool yy_map_write_file(yy_map_t *map, const char *path) {
+    _yy_map_write_context ctx;
+    yy_file_header_t header;
+    uint64_t *slots, slot_count, i, j;
+    bool ok;
+    
+    if (path == NULL) return false;
+    if (map->key_callback.hash != _yy_map_string_hash_callbak) {
+        yy_log_error("yy_map_t(%p):%s() only maps with string keys can be written",
+                     map, __func__);
+        return false;
+    }
+    if (map->value_callback.equal != _yy_map_string_equal_callback) {
+        /* values of another kind are fine if there are none */
+        ok = true;
+        yy_map_foreach(map, _yy_map_write_check_null, &ok);
+        if (!ok) {
+            yy_log_error("yy_map_t(%p):%s() only maps with string values (or NULL) can be written",
+                         map, __func__);
+            return false;
+        }
+    }
+    
+    slot_count = YY_MAP_MIN_BUCKET_COUNT;
+    while (slot_count < (uint64_t)map->node_count * 2) slot_count <<= 1;
+    
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.map = map;
+    ctx.entries = malloc(YY_MAX(map->node_count, 1) * sizeof(yy_file_map_entry_t));
+    slots = calloc(slot_count, sizeof(uint64_t));
+    if (ctx.entries == NULL || slots == NULL) {
+        yy_log_error("yy_map_t(%p):%s() attempt to allocate %ld bytes failed",
+                     map, __func__, map->node_count * sizeof(yy_file_map_entry_t) + slot_count * sizeof(uint64_t));
+        free(ctx.entries);
+        free(slots);
+        return false;
+    }
+    yy_map_foreach(map, _yy_map_write_measure, &ctx);
+    for (i = 0; i < (uint64_t)ctx.count; i++) {
+        j = ctx.entries[i].hash & (slot_count - 1);
+        while (slots[j]) j = (j + 1) & (slot_count - 1);
+        slots[j] = i + 1;
+    }
+    
+    memset(&header, 0, sizeof(header));
+    header.magic = YY_FILE_MAP_MAGIC;
+    header.version = YY_FILE_VERSION;
+    header.count = ctx.count;
+    header.table_offset = _yy_file_align(sizeof(header));
+    header.slot_offset = header.table_offset + _yy_file_align(ctx.count * sizeof(yy_file_map_entry_t));
+    header.slot_count = slot_count;
+    header.blob_offset = header.slot_offset + slot_count * sizeof(uint64_t);
+    header.blob_size = ctx.blob_size;
+    
+    ctx.fp = fopen(path, "wb");
+    if (ctx.fp == NULL) {
+        yy_log_error("yy_map_t(%p):%s() cannot open file(%s)",
+                     map, __func__, path);
+        free(ctx.entries);
+        free(slots);
+        return false;
+    }
+    ctx.ok = _yy_file_write(ctx.fp, &header, sizeof(header))
+        && _yy_file_pad(ctx.fp, sizeof(header))
+        && _yy_file_write(ctx.fp, ctx.entries, ctx.count * sizeof(yy_file_map_entry_t))
+        && _yy_file_pad(ctx.fp, ctx.count * sizeof(yy_file_map_entry_t))
+        && _yy_file_write(ctx.fp, slots, slot_count * sizeof(uint64_t));
+    yy_map_foreach(map, _yy_map_write_strings, &ctx);
+    ok = ctx.ok && _yy_file_pad(ctx.fp, ctx.blob_size);
+    ok = (fclose(ctx.fp) == 0) && ok;
+    free(ctx.entries);
+    free(slots);
+    if (!ok) {
+        yy_log_error("yy_map_t(%p):%s() write file(%s) failed",
+                     map, __func__, path);
+    }
+    return ok;
+}
+
+yy_map_t *yy_map_create_with_file(const char *path) {
+    yy_file_view_t *view;
+    yy_map_t *map;
+    
+    view = _yy_file_view_open(path, YY_FILE_MAP_MAGIC);
+    if (view == NULL) return NULL;
+    map = yy_map_create_with_options(0, &yy_map_string_key_callback, &yy_map_string_value_callback);
+    if (map == NULL) {
+        _yy_file_view_release(view);
+        return NULL;
+    }
+    map->view = view;
+    map->node_count = (long)view->header->count;
+    return map;
+}
@@ -87,10 +87,110 @@ bool yy_map_contains_value(yy_map_t *map,const void *value);
 const void *yy_map_get(yy_map_t *map, const void *key);
 bool yy_map_set(yy_map_t *map, const void *key, const void *value);
 bool yy_map_set_all(yy_map_t *map, yy_map_t *add);
+
+/// Look up `count` keys at once, writes NULL for missing keys. Returns the number of keys found.
+long yy_map_get_many(yy_map_t *map, const void **keys, long count, const void **values);
+/// Set `count` key-value pairs at once, the map is resized at most once.
+bool yy_map_set_many(yy_map_t *map, const void **keys, long count, const void **values);
 bool yy_map_remove(yy_map_t *map, const void *key);
 bool yy_map_clear(yy_map_t *map);
 bool yy_map_get_all_keys(yy_map_t *map, const void **keys);
 bool yy_map_foreach(yy_map_t *map, yy_map_foreach_func func, void *context);
 yy_array_t *yy_map_create_key_array(yy_map_t *map);
 
+/**
+ Precomputed hash.
+
+ `hash` is the value returned by the key hash callback (yy_map_hash_key()),
+ the map still mixes it. It can be reused for every map with the same hash
+ callback, e.g. to probe several maps with one key.
+ */
+unsigned long yy_map_hash_key(yy_map_t *map, const void *key);
+const void *yy_map_get_with_hash(yy_map_t *map, const void *key, unsigned long hash);
+bool yy_map_set_with_hash(yy_map_t *map, const void *key, unsigned long hash, const void *value);
+bool yy_map_remove_with_hash(yy_map_t *map, const void *key, unsigned long hash);
+
+/**
+ Ownership transfer, without retain/release.
+
+ yy_map_set_transfer() adopts a key and a value the caller already owns (e.g.
+ a malloc'ed string with yy_map_string_key_callback): the retain callbacks
+ are not called. If the key is already present, the passed key is released
+ and the stored one is kept (even if they are the same pointer), a value
+ that is already the stored one is released too. On failure the caller
+ still owns both.
+
+ yy_map_take() removes a key and hands its value to the caller: the value
+ release callback is not called (the key is released as usual).
+ */
+bool yy_map_set_transfer(yy_map_t *map, const void *key, const void *value);
+bool yy_map_take(yy_map_t *map, const void *key, const void **value);
+
+/// Negative lookup filter of a map.
+typedef enum {
+    YY_MAP_FILTER_NONE = 0,
+    YY_MAP_FILTER_BLOOM,            ///< 1 byte per bucket, removed keys stay until the next resize or clear
+    YY_MAP_FILTER_COUNTING_BLOOM    ///< 4 bytes per bucket, removed keys are cleared at once
+} yy_map_filter_type;
+
+/**
+ Attach a blocked Bloom filter to the map (or remove it with YY_MAP_FILTER_NONE).
+ 
+ Lookups of missing keys are answered by the filter (one cache line) most of
+ the time, without touching the buckets or calling the equal callback. The
+ filter is updated by set/remove and rebuilt with the buckets on resize.
+ Worth it when most lookups miss, it slows down inserts a little.
+ Maps mapped from file cannot have a filter.
+ */
+bool yy_map_set_filter(yy_map_t *map, yy_map_filter_type type);
+yy_map_filter_type yy_map_get_filter(yy_map_t *map);
+
+/// Estimated probability that a missing key passes the filter (1 without filter).
+double yy_map_get_filter_false_positive_rate(yy_map_t *map);
+
+/**
+ Incrementally iterate the map (similar to redis SCAN).
+ 
+ Start with *cursor = 0, each call writes at most `batch` pairs to
+ keys/values (values can be NULL) and updates the cursor, the scan is
+ complete when the cursor becomes 0 again (a call may return 0 pairs before
+ that). Every key present for the whole scan is returned at least once, even
+ if the map is modified between calls (keys may be returned more than once).
+ The keys of a bucket are always returned by the same call, if the next
+ bucket alone does not fit in `batch`, nothing is written and the batch it
+ needs is returned as a negative number. Never allocates.
+ 
+ Example:
+ unsigned long cursor = 0;
+ long capacity = 64;
+ const void **keys = malloc(capacity * sizeof(void *));
+ do {
+     long n = yy_map_scan(map, &cursor, capacity, keys, NULL);
+     if (n < -1) {
+         capacity = -n;
+         keys = realloc(keys, capacity * sizeof(void *));
+         n = yy_map_scan(map, &cursor, capacity, keys, NULL);
+     }
+     ...
+ } while (cursor != 0);
+ 
+ @return the number of pairs written, -n if the next bucket holds n pairs
+         (more than `batch`), or -1 if the arguments are invalid.
+ */
+long yy_map_scan(yy_map_t *map, unsigned long *cursor, long batch, const void **keys, const void **values);
+
+/**
+ Write a map of C string keys (yy_map_string_key_callback) and C string
+ values (yy_map_string_value_callback, or only NULL values) to a binary
+ file, with a prebuilt hash index.
+ */
+bool yy_map_write_file(yy_map_t *map, const char *path);
+
+/**
+ Create a read-only string map from a file written by yy_map_write_file().
+ The file is mapped into memory and queried in place, keys and values point
+ into the mapping. Modifications fail, except yy_map_clear() which drops the mapping.
+ */
+yy_map_t *yy_map_create_with_file(const char *path);
+
 #endif
@@ -0,0 +1,50 @@
+//
+//  yy_map_private.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_map_private_h
+#define YYMidiBase_yy_map_private_h
+
+#include "yy_map.h"
+
+/*
+ Node access for the containers built on yy_map (yy_cache).
+
+ A map created with a larger node size allocates every node with extra
+ zeroed bytes right after yy_map_node_t, the owner can embed its own fields
+ there. Nodes never move while they are in the map (a resize only relinks
+ them), so they can be linked into other lists.
+ */
+
+typedef struct _yy_map_node   yy_map_node_t;
+
+struct _yy_map_node {
+    const void *key;
+    const void *value;
+    unsigned long hash;     ///< mixed hash
+    yy_map_node_t *next;
+};
+
+/// Create a map whose nodes are node_size bytes (at least sizeof(yy_map_node_t)).
+yy_map_t * _yy_map_create_with_node_size(long capacity,
+                                         const yy_map_key_callback_t *key_callback,
+                                         const yy_map_value_callback_t *value_callback,
+                                         long node_size);
+
+/// Find the node of a key, NULL if not found.
+yy_map_node_t * _yy_map_find_node(yy_map_t *map, const void *key);
+
+/**
+ Set a key-value pair like yy_map_set() and return its node (NULL on failure).
+ added is set to true if the key was not in the map (its node is new).
+ */
+yy_map_node_t * _yy_map_set_node(yy_map_t *map, const void *key, const void *value, bool *added);
+
+/// Remove a node of the map, releasing its key and value.
+void _yy_map_remove_node(yy_map_t *map, yy_map_node_t *node);
+
+#endif
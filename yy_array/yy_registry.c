@@ -0,0 +1,401 @@
+//
+//  yy_registry.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_registry.h"
+#include "yy_base_private.h"
+
+#include <string.h>
+
+#ifdef YY_ENABLE_REGISTRY
+
+#include <stdint.h>
+#include <pthread.h>
+#include <execinfo.h>
+
+#define YY_REGISTRY_MAX_TYPES 64        ///< type 0 collects the types beyond
+#define YY_REGISTRY_SHARD_COUNT 16      ///< object lists, power of 2
+#define YY_REGISTRY_FLUSH_BYTES 65536   ///< a thread publishes its counters after this many bytes
+#define YY_REGISTRY_FLUSH_COUNT 64      ///< or this many allocations and deallocations
+#define YY_REGISTRY_SAMPLE_RATE 64
+
+typedef struct _yy_registry_type {
+    void *(*dealloc)(void *);           ///< identifies the type
+    const char *name;
+    long live_count;
+    long live_bytes;
+    long peak_bytes;
+    long total_count;
+} yy_registry_type_t;
+
+typedef struct _yy_registry_counter {
+    long count;
+    long bytes;
+    long total;
+} yy_registry_counter_t;
+
+/// Counters of a thread, not published yet.
+typedef struct _yy_registry_thread {
+    yy_registry_counter_t types[YY_REGISTRY_MAX_TYPES];
+    long pending_bytes;
+    long pending_count;
+    long sample_countdown;
+    bool registered;                    ///< the key destructor will flush at exit (cleared once it ran)
+} yy_registry_thread_t;
+
+typedef struct _yy_registry_shard {
+    pthread_mutex_t lock;
+    yy_object *first;
+} yy_registry_shard_t;
+
+static pthread_once_t _yy_registry_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t _yy_registry_types_lock;
+static pthread_key_t _yy_registry_thread_key;
+static yy_registry_type_t _yy_registry_types[YY_REGISTRY_MAX_TYPES];
+static int _yy_registry_type_count;
+static yy_registry_shard_t _yy_registry_shards[YY_REGISTRY_SHARD_COUNT];
+static long _yy_registry_live_bytes;
+static long _yy_registry_peak_bytes;
+static long _yy_registry_sample_rate = YY_REGISTRY_SAMPLE_RATE;
+static __thread yy_registry_thread_t _yy_registry_thread;
+
+yy_inline void _yy_registry_atomic_max(long *value, long new_value) {
+    long old_value = __atomic_load_n(value, __ATOMIC_RELAXED);
+    while (old_value < new_value
+           && !__atomic_compare_exchange_n(value, &old_value, new_value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/// Add the counters of a thread to the global ones.
+static void _yy_registry_thread_flush(yy_registry_thread_t *thread) {
+    yy_registry_counter_t *counter;
+    yy_registry_type_t *type;
+    long i, count, bytes;
+    
+    count = __atomic_load_n(&_yy_registry_type_count, __ATOMIC_ACQUIRE);
+    for (i = 0; i < count; i++) {
+        counter = thread->types + i;
+        if (counter->count == 0 && counter->bytes == 0 && counter->total == 0) continue;
+        type = _yy_registry_types + i;
+        __atomic_add_fetch(&type->live_count, counter->count, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&type->total_count, counter->total, __ATOMIC_RELAXED);
+        bytes = __atomic_add_fetch(&type->live_bytes, counter->bytes, __ATOMIC_RELAXED);
+        _yy_registry_atomic_max(&type->peak_bytes, bytes);
+        bytes = __atomic_add_fetch(&_yy_registry_live_bytes, counter->bytes, __ATOMIC_RELAXED);
+        _yy_registry_atomic_max(&_yy_registry_peak_bytes, bytes);
+        counter->count = 0;
+        counter->bytes = 0;
+        counter->total = 0;
+    }
+    thread->pending_bytes = 0;
+    thread->pending_count = 0;
+}
+
+/// Flush at thread exit, counts made later in the teardown register the thread again.
+static void _yy_registry_thread_exit(void *value) {
+    yy_registry_thread_t *thread = value;
+    
+    _yy_registry_thread_flush(thread);
+    thread->registered = false;
+}
+
+static void _yy_registry_init() {
+    long i;
+    
+    pthread_mutex_init(&_yy_registry_types_lock, NULL);
+    pthread_key_create(&_yy_registry_thread_key, _yy_registry_thread_exit);
+    for (i = 0; i < YY_REGISTRY_SHARD_COUNT; i++) {
+        pthread_mutex_init(&_yy_registry_shards[i].lock, NULL);
+    }
+    _yy_registry_types[0].name = "(other)";
+    _yy_registry_type_count = 1;
+}
+
+yy_inline yy_registry_thread_t * _yy_registry_get_thread() {
+    yy_registry_thread_t *thread = &_yy_registry_thread;
+    
+    if (!thread->registered) {
+        pthread_once(&_yy_registry_once, _yy_registry_init);
+        pthread_setspecific(_yy_registry_thread_key, thread);
+        thread->sample_countdown = __atomic_load_n(&_yy_registry_sample_rate, __ATOMIC_RELAXED);
+        thread->registered = true;
+    }
+    return thread;
+}
+
+yy_inline yy_registry_shard_t * _yy_registry_get_shard(yy_object *o) {
+    return _yy_registry_shards + (((uintptr_t)o >> 6) & (YY_REGISTRY_SHARD_COUNT - 1));
+}
+
+/// Index of the type with this dealloc function, registered on first use.
+static int _yy_registry_get_type(void *(*dealloc)(void *), const char *name) {
+    int i, count;
+    
+    count = __atomic_load_n(&_yy_registry_type_count, __ATOMIC_ACQUIRE);
+    for (i = 1; i < count; i++) {
+        if (_yy_registry_types[i].dealloc == dealloc) return i;
+    }
+    pthread_mutex_lock(&_yy_registry_types_lock);
+    count = _yy_registry_type_count;
+    for (i = 1; i < count; i++) {
+        if (_yy_registry_types[i].dealloc == dealloc) break;
+    }
+    if (i == count) {
+        if (count < YY_REGISTRY_MAX_TYPES) {
+            _yy_registry_types[i].dealloc = dealloc;
+            _yy_registry_types[i].name = name ? name : "(unnamed)";
+            __atomic_store_n(&_yy_registry_type_count, count + 1, __ATOMIC_RELEASE);
+        } else {
+            i = 0;
+        }
+    }
+    pthread_mutex_unlock(&_yy_registry_types_lock);
+    return i;
+}
+
+yy_inline void _yy_registry_count(yy_registry_thread_t *thread, int type, long count, long bytes) {
+    yy_registry_counter_t *counter = thread->types + type;
+    
+    counter->count += count;
+    counter->bytes += bytes;
+    if (count > 0) counter->total += count;
+    thread->pending_bytes += YY_ABS(bytes);
+    thread->pending_count += YY_ABS(count);
+    if (thread->pending_bytes >= YY_REGISTRY_FLUSH_BYTES || thread->pending_count >= YY_REGISTRY_FLUSH_COUNT) {
+        _yy_registry_thread_flush(thread);
+    }
+}
+
+void _yy_registry_add(yy_object *o, size_t size, void *(*dealloc)(void *), const char *name) {
+    yy_registry_thread_t *thread = _yy_registry_get_thread();
+    yy_registry_shard_t *shard;
+    void *frames[YY_REGISTRY_MAX_FRAMES + 1];
+    long rate;
+    int count;
+    
+    o->registry.type = _yy_registry_get_type(dealloc, name);
+    o->registry.bytes = sizeof(yy_object) + size;
+    
+    rate = __atomic_load_n(&_yy_registry_sample_rate, __ATOMIC_RELAXED);
+    if (rate > 0 && --thread->sample_countdown <= 0) {
+        thread->sample_countdown = rate;
+        /* skip the frame of this function */
+        count = backtrace(frames, YY_REGISTRY_MAX_FRAMES + 1) - 1;
+        if (count > 0) {
+            o->registry.frames = malloc(count * sizeof(void *));
+            if (o->registry.frames) {
+                memcpy(o->registry.frames, frames + 1, count * sizeof(void *));
+                o->registry.frame_count = count;
+            }
+        }
+    }
+    
+    shard = _yy_registry_get_shard(o);
+    pthread_mutex_lock(&shard->lock);
+    o->registry.next = shard->first;
+    if (shard->first) shard->first->registry.prev = o;
+    shard->first = o;
+    pthread_mutex_unlock(&shard->lock);
+    
+    _yy_registry_count(thread, o->registry.type, 1, o->registry.bytes);
+}
+
+void _yy_registry_remove(yy_object *o) {
+    yy_registry_thread_t *thread = _yy_registry_get_thread();
+    yy_registry_shard_t *shard = _yy_registry_get_shard(o);
+    
+    pthread_mutex_lock(&shard->lock);
+    if (o->registry.prev) o->registry.prev->registry.next = o->registry.next;
+    else shard->first = o->registry.next;
+    if (o->registry.next) o->registry.next->registry.prev = o->registry.prev;
+    pthread_mutex_unlock(&shard->lock);
+    
+    free(o->registry.frames);
+    _yy_registry_count(thread, o->registry.type, -1, -o->registry.bytes);
+}
+
+void _yy_registry_set_bytes(void *object, long bytes) {
+    yy_object *o = (yy_object *)object - 1;
+    long delta;
+    
+    bytes += sizeof(yy_object);
+    delta = bytes - o->registry.bytes;
+    if (delta == 0) return;
+    __atomic_store_n(&o->registry.bytes, bytes, __ATOMIC_RELAXED);
+    _yy_registry_count(_yy_registry_get_thread(), o->registry.type, 0, delta);
+}
+
+static void _yy_registry_get_info(yy_object *o, yy_registry_object_info_t *info) {
+    info->object = o + 1;
+    info->type = _yy_registry_types[o->registry.type].name;
+    info->bytes = __atomic_load_n(&o->registry.bytes, __ATOMIC_RELAXED);
+    info->frame_count = o->registry.frame_count;
+    if (info->frame_count > 0) {
+        memcpy(info->frames, o->registry.frames, info->frame_count * sizeof(void *));
+    }
+}
+
+bool yy_registry_enabled() {
+    return true;
+}
+
+void yy_registry_set_sample_rate(long rate) {
+    __atomic_store_n(&_yy_registry_sample_rate, rate > 0 ? rate : 0, __ATOMIC_RELAXED);
+}
+
+void yy_registry_flush() {
+    _yy_registry_thread_flush(_yy_registry_get_thread());
+}
+
+long yy_registry_get_types(yy_registry_type_info_t *infos, long max_count) {
+    yy_registry_type_t *type;
+    long i, count, filled;
+    
+    yy_registry_flush();
+    count = __atomic_load_n(&_yy_registry_type_count, __ATOMIC_ACQUIRE);
+    filled = 0;
+    for (i = 0; i < count; i++) {
+        type = _yy_registry_types + i;
+        if (i == 0 && __atomic_load_n(&type->total_count, __ATOMIC_RELAXED) == 0) continue;
+        if (infos && filled < max_count) {
+            infos[filled].name = type->name;
+            infos[filled].live_count = __atomic_load_n(&type->live_count, __ATOMIC_RELAXED);
+            infos[filled].live_bytes = __atomic_load_n(&type->live_bytes, __ATOMIC_RELAXED);
+            infos[filled].peak_bytes = __atomic_load_n(&type->peak_bytes, __ATOMIC_RELAXED);
+            infos[filled].total_count = __atomic_load_n(&type->total_count, __ATOMIC_RELAXED);
+        }
+        filled++;
+    }
+    return filled;
+}
+
+void yy_registry_get_total(long *live_bytes, long *peak_bytes) {
+    yy_registry_flush();
+    if (live_bytes) *live_bytes = __atomic_load_n(&_yy_registry_live_bytes, __ATOMIC_RELAXED);
+    if (peak_bytes) *peak_bytes = __atomic_load_n(&_yy_registry_peak_bytes, __ATOMIC_RELAXED);
+}
+
+long yy_registry_get_largest(yy_registry_object_info_t *infos, long max_count) {
+    yy_registry_shard_t *shard;
+    yy_object *o;
+    long i, j, count, bytes;
+    
+    if (infos == NULL || max_count <= 0) return 0;
+    pthread_once(&_yy_registry_once, _yy_registry_init);
+    count = 0;
+    for (i = 0; i < YY_REGISTRY_SHARD_COUNT; i++) {
+        shard = _yy_registry_shards + i;
+        pthread_mutex_lock(&shard->lock);
+        for (o = shard->first; o; o = o->registry.next) {
+            /* insertion into the sorted infos */
+            bytes = __atomic_load_n(&o->registry.bytes, __ATOMIC_RELAXED);
+            if (count == max_count && bytes <= infos[count - 1].bytes) continue;
+            j = count < max_count ? count++ : count - 1;
+            for (; j > 0 && infos[j - 1].bytes < bytes; j--) {
+                infos[j] = infos[j - 1];
+            }
+            _yy_registry_get_info(o, infos + j);
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return count;
+}
+
+bool yy_registry_foreach(yy_registry_object_func func, void *context) {
+    yy_registry_object_info_t info;
+    yy_registry_shard_t *shard;
+    yy_object *o;
+    bool stop = false;
+    long i;
+    
+    if (!func) return false;
+    pthread_once(&_yy_registry_once, _yy_registry_init);
+    for (i = 0; i < YY_REGISTRY_SHARD_COUNT && !stop; i++) {
+        shard = _yy_registry_shards + i;
+        pthread_mutex_lock(&shard->lock);
+        for (o = shard->first; o && !stop; o = o->registry.next) {
+            _yy_registry_get_info(o, &info);
+            stop = !func(&info, context);
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return true;
+}
+
+void yy_registry_dump(FILE *file, long largest_count) {
+    yy_registry_type_info_t types[YY_REGISTRY_MAX_TYPES];
+    yy_registry_object_info_t *infos;
+    long i, count, live_bytes, peak_bytes;
+    int f;
+    char **symbols;
+    
+    if (file == NULL) file = stdout;
+    count = YY_MIN(yy_registry_get_types(types, YY_REGISTRY_MAX_TYPES), YY_REGISTRY_MAX_TYPES);
+    yy_registry_get_total(&live_bytes, &peak_bytes);
+    fprintf(file, "yy_registry: %.3f KB live, %.3f KB peak\n", live_bytes / 1024.0, peak_bytes / 1024.0);
+    fprintf(file, "  %-24s %10s %14s %14s %10s\n", "type", "live", "live KB", "peak KB", "total");
+    for (i = 0; i < count; i++) {
+        fprintf(file, "  %-24s %10ld %14.3f %14.3f %10ld\n", types[i].name, types[i].live_count,
+                types[i].live_bytes / 1024.0, types[i].peak_bytes / 1024.0, types[i].total_count);
+    }
+    if (largest_count <= 0) return;
+    infos = malloc(largest_count * sizeof(yy_registry_object_info_t));
+    if (infos == NULL) return;
+    count = yy_registry_get_largest(infos, largest_count);
+    for (i = 0; i < count; i++) {
+        fprintf(file, "  #%ld %s(%p) %.3f KB\n", i, infos[i].type, infos[i].object, infos[i].bytes / 1024.0);
+        if (infos[i].frame_count == 0) continue;
+        symbols = backtrace_symbols(infos[i].frames, infos[i].frame_count);
+        for (f = 0; symbols && f < infos[i].frame_count; f++) {
+            fprintf(file, "      %s\n", symbols[f]);
+        }
+        free(symbols);
+    }
+    free(infos);
+}
+
+#else
+
+bool yy_registry_enabled() {
+    return false;
+}
+
+void yy_registry_set_sample_rate(long rate) {
+    (void)rate;
+}
+
+void yy_registry_flush() {
+}
+
+long yy_registry_get_types(yy_registry_type_info_t *infos, long max_count) {
+    (void)infos;
+    (void)max_count;
+    return 0;
+}
+
+void yy_registry_get_total(long *live_bytes, long *peak_bytes) {
+    if (live_bytes) *live_bytes = 0;
+    if (peak_bytes) *peak_bytes = 0;
+}
+
+long yy_registry_get_largest(yy_registry_object_info_t *infos, long max_count) {
+    (void)infos;
+    (void)max_count;
+    return 0;
+}
+
+bool yy_registry_foreach(yy_registry_object_func func, void *context) {
+    (void)func;
+    (void)context;
+    return false;
+}
+
+void yy_registry_dump(FILE *file, long largest_count) {
+    (void)largest_count;
+    fprintf(file ? file : stdout, "yy_registry: disabled, build with YY_ENABLE_REGISTRY\n");
+}
+
+#endif
@@ -0,0 +1,81 @@
+//
+//  yy_registry.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_registry_h
+#define YYMidiBase_yy_registry_h
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "yy_base.h"
+
+#define YY_REGISTRY_MAX_FRAMES 16
+
+typedef struct _yy_registry_type_info {
+    const char *name;       ///< name of the struct, e.g. "yy_map_t"
+    long live_count;        ///< objects alive
+    long live_bytes;        ///< bytes held by these objects (ring, buckets, nodes included)
+    long peak_bytes;        ///< high-water mark of live_bytes
+    long total_count;       ///< objects allocated since start
+} yy_registry_type_info_t;
+
+typedef struct _yy_registry_object_info {
+    const void *object;
+    const char *type;
+    long bytes;
+    int frame_count;        ///< 0 if the allocation was not sampled
+    void *frames[YY_REGISTRY_MAX_FRAMES]; ///< allocation stack (see backtrace_symbols())
+} yy_registry_object_info_t;
+
+/// Prototype of a function applied to the live objects, return false to stop.
+typedef bool (*yy_registry_object_func)(const yy_registry_object_info_t *info, void *context);
+
+
+/**
+ YY Registry  (live yy objects and their memory)
+ 
+ When the library is built with YY_ENABLE_REGISTRY defined (in all its files),
+ every yy object is registered when allocated, with its type and the bytes
+ it holds, which the containers update as they grow. One allocation in
+ `sample rate` records its call stack. Otherwise the functions below do
+ nothing and report nothing.
+ 
+ The counters are kept per thread and added to the global ones by batches,
+ so the counts may lag behind by a few objects per thread, call
+ yy_registry_flush() from a thread to publish its counters now.
+ 
+ Example:
+ yy_registry_dump(stdout, 10);  // types, and the 10 largest objects
+ */
+bool yy_registry_enabled();
+
+/// Record the call stack of one allocation in `rate` (0 to disable), 64 by default.
+void yy_registry_set_sample_rate(long rate);
+
+/// Publish the counters of the calling thread.
+void yy_registry_flush();
+
+/// Get the types which have been allocated, returns the number of types (may exceed max_count).
+long yy_registry_get_types(yy_registry_type_info_t *infos, long max_count);
+
+/// Bytes held by all the live objects, and the high-water mark.
+void yy_registry_get_total(long *live_bytes, long *peak_bytes);
+
+/// Get the largest live objects (by bytes, descending), returns the number of infos filled.
+long yy_registry_get_largest(yy_registry_object_info_t *infos, long max_count);
+
+/**
+ Apply func to every live object. The registry is locked meanwhile:
+ func must not allocate or release yy objects.
+ */
+bool yy_registry_foreach(yy_registry_object_func func, void *context);
+
+/// Print the types and the `largest_count` largest objects to file (stdout if NULL).
+void yy_registry_dump(FILE *file, long largest_count);
+
+#endif
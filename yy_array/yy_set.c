@@ -0,0 +1,421 @@
+//
+//  yy_set.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_set.h"
+#include "yy_base_private.h"
+#include "yy_log.h"
+
+#include <string.h>
+#include <limits.h>
+
+/// Minimum slot count, the slot count is always a power of 2.
+#define YY_SET_MIN_CAPACITY 16
+
+/// Hash 0 marks an empty slot (stored hashes are never 0).
+#define YY_SET_EMPTY_HASH 0
+
+typedef struct _yy_set_slot {
+    const void *key;
+    unsigned long hash;     ///< mixed hash of the key
+} yy_set_slot_t;
+
+struct _yy_set {
+    long count;
+    long capacity;          ///< slot count
+    long max_count;         ///< grow when the set holds more keys (3/4 of capacity)
+    yy_set_slot_t *slots;
+    yy_map_key_callback_t key_callback;
+};
+
+/**
+ * Pointer Hash Function.
+ */
+static unsigned long _yy_set_hash_callback_default(const void *key) {
+    return (unsigned long)key;
+}
+
+/**
+ * Mix the bits of a user hash (_yy_hash_mix), never returns 0.
+ */
+yy_inline unsigned long _yy_set_hash(yy_set_t *set, const void *key) {
+    uint64_t h = _yy_hash_mix(set->key_callback.hash(key));
+    return h == YY_SET_EMPTY_HASH ? 1 : (unsigned long)h;
+}
+
+/**
+ * Hash of a key taken from `from`, to be looked up in `set`.
+ */
+yy_inline unsigned long _yy_set_rehash(yy_set_t *set, yy_set_t *from, const yy_set_slot_t *slot) {
+    if (set->key_callback.hash == from->key_callback.hash) return slot->hash;
+    return _yy_set_hash(set, slot->key);
+}
+
+yy_inline long _yy_set_capacity_for_count(long count) {
+    long capacity = YY_SET_MIN_CAPACITY;
+    while (capacity - capacity / 4 < count) capacity <<= 1;
+    return capacity;
+}
+
+yy_inline yy_set_slot_t *_yy_set_find(yy_set_t *set, const void *key, unsigned long hash) {
+    yy_set_slot_t *slot;
+    unsigned long mask, index;
+    
+    mask = set->capacity - 1;
+    index = hash & mask;
+    for (;;) {
+        slot = set->slots + index;
+        if (slot->hash == YY_SET_EMPTY_HASH) return NULL;
+        if (slot->hash == hash
+            && (slot->key == key
+                || (set->key_callback.equal && set->key_callback.equal(slot->key, key)))) {
+            return slot;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+/// First empty slot of the probe sequence of hash.
+yy_inline yy_set_slot_t *_yy_set_find_empty(yy_set_slot_t *slots, long capacity, unsigned long hash) {
+    unsigned long mask, index;
+    
+    mask = capacity - 1;
+    index = hash & mask;
+    while (slots[index].hash != YY_SET_EMPTY_HASH) index = (index + 1) & mask;
+    return slots + index;
+}
+
+static bool _yy_set_resize(yy_set_t *set, long capacity) {
+    yy_set_slot_t *slots;
+    long i;
+    
+    if (capacity > LONG_MAX / (long)sizeof(yy_set_slot_t)) {
+        yy_log_error("yy_set_t(%p):%s() capacity(%ld) overflow", set, __func__, capacity);
+        return false;
+    }
+    slots = calloc(capacity, sizeof(yy_set_slot_t));
+    if (slots == NULL) {
+        yy_log_error("yy_set_t(%p):%s() attempt to allocate %ld bytes failed",
+                     set, __func__, capacity * sizeof(yy_set_slot_t));
+        return false;
+    }
+    for (i = 0; i < set->capacity; i++) {
+        if (set->slots[i].hash == YY_SET_EMPTY_HASH) continue;
+        *_yy_set_find_empty(slots, capacity, set->slots[i].hash) = set->slots[i];
+    }
+    free(set->slots);
+    set->slots = slots;
+    set->capacity = capacity;
+    set->max_count = capacity - capacity / 4;
+    YY_REGISTRY_SET_BYTES(set, sizeof(yy_set_t) + capacity * sizeof(yy_set_slot_t));
+    return true;
+}
+
+static bool _yy_set_add_with_hash(yy_set_t *set, const void *key, unsigned long hash) {
+    yy_set_slot_t *slot;
+    
+    if (_yy_set_find(set, key, hash)) return true;
+    if (set->count >= set->max_count && !_yy_set_resize(set, set->capacity << 1)) {
+        return false;
+    }
+    slot = _yy_set_find_empty(set->slots, set->capacity, hash);
+    slot->key = set->key_callback.retain ? set->key_callback.retain(key) : key;
+    slot->hash = hash;
+    set->count++;
+    return true;
+}
+
+/// Release the key of slot and shift back the rest of its cluster.
+static void _yy_set_remove_slot(yy_set_t *set, yy_set_slot_t *slot) {
+    unsigned long mask, hole, index, home;
+    
+    if (set->key_callback.release) set->key_callback.release(slot->key);
+    mask = set->capacity - 1;
+    hole = slot - set->slots;
+    index = hole;
+    for (;;) {
+        index = (index + 1) & mask;
+        slot = set->slots + index;
+        if (slot->hash == YY_SET_EMPTY_HASH) break;
+        home = slot->hash & mask;
+        if (((index - home) & mask) >= ((index - hole) & mask)) {
+            set->slots[hole] = *slot;
+            hole = index;
+        }
+    }
+    set->slots[hole].key = NULL;
+    set->slots[hole].hash = YY_SET_EMPTY_HASH;
+    set->count--;
+}
+
+static void _yy_set_release_keys(yy_set_t *set) {
+    long i;
+    
+    if (set->key_callback.release == NULL) return;
+    for (i = 0; i < set->capacity; i++) {
+        if (set->slots[i].hash != YY_SET_EMPTY_HASH) set->key_callback.release(set->slots[i].key);
+    }
+}
+
+static void _yy_set_dealloc(yy_set_t *set) {
+    _yy_set_release_keys(set);
+    free(set->slots);
+    yy_dealloc(set);
+}
+
+yy_set_t *yy_set_create() {
+    return yy_set_create_with_options(0, NULL);
+}
+
+yy_set_t *yy_set_create_with_options(long capacity, const yy_map_key_callback_t *key_callback) {
+    yy_set_t *set;
+    
+    if (capacity < 0) {
+        yy_log_error("%s() capacity(%ld) cannot be less than zero", __func__, capacity);
+        return NULL;
+    }
+    set = yy_alloc(yy_set_t, _yy_set_dealloc);
+    if (set == NULL) {
+        yy_log_error("yy_set_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_set_t));
+        return NULL;
+    }
+    if (key_callback) set->key_callback = *key_callback;
+    if (set->key_callback.hash == NULL) {
+        set->key_callback.hash = _yy_set_hash_callback_default;
+    }
+    if (!_yy_set_resize(set, _yy_set_capacity_for_count(capacity))) {
+        yy_release(set);
+        return NULL;
+    }
+    return set;
+}
+
+yy_set_t *yy_set_create_copy(yy_set_t *set) {
+    yy_set_t *new_set;
+    long i;
+    
+    if (set == NULL) {
+        yy_log_error("%s() input set cannot be null", __func__);
+        return NULL;
+    }
+    new_set = yy_set_create_with_options(0, &set->key_callback);
+    if (new_set == NULL) return NULL;
+    if (new_set->capacity != set->capacity && !_yy_set_resize(new_set, set->capacity)) {
+        yy_release(new_set);
+        return NULL;
+    }
+    
+    /* same capacity and hashes: the slots can be copied as they are */
+    memcpy(new_set->slots, set->slots, set->capacity * sizeof(yy_set_slot_t));
+    new_set->count = set->count;
+    if (new_set->key_callback.retain) {
+        for (i = 0; i < new_set->capacity; i++) {
+            if (new_set->slots[i].hash == YY_SET_EMPTY_HASH) continue;
+            new_set->slots[i].key = new_set->key_callback.retain(new_set->slots[i].key);
+        }
+    }
+    return new_set;
+}
+
+yy_set_t *yy_set_create_with_array(yy_array_t *array, const yy_map_key_callback_t *key_callback) {
+    yy_set_t *set;
+    const void *key;
+    long i, count;
+    
+    if (array == NULL) {
+        yy_log_error("%s() input array cannot be null", __func__);
+        return NULL;
+    }
+    count = yy_array_count(array);
+    set = yy_set_create_with_options(count, key_callback);
+    if (set == NULL) return NULL;
+    for (i = 0; i < count; i++) {
+        key = yy_array_get(array, i);
+        if (!_yy_set_add_with_hash(set, key, _yy_set_hash(set, key))) {
+            yy_release(set);
+            return NULL;
+        }
+    }
+    return set;
+}
+
+yy_array_t *yy_set_create_array(yy_set_t *set) {
+    yy_array_callback_t callback;
+    yy_array_t *array;
+    long i;
+    
+    callback.retain = set->key_callback.retain;
+    callback.release = set->key_callback.release;
+    callback.equal = set->key_callback.equal;
+    array = yy_array_create_with_options(set->count, &callback);
+    if (array == NULL) return NULL;
+    for (i = 0; i < set->capacity; i++) {
+        if (set->slots[i].hash == YY_SET_EMPTY_HASH) continue;
+        if (!yy_array_append(array, set->slots[i].key)) {
+            yy_release(array);
+            return NULL;
+        }
+    }
+    return array;
+}
+
+long yy_set_count(yy_set_t *set) {
+    return set->count;
+}
+
+bool yy_set_contains(yy_set_t *set, const void *key) {
+    return _yy_set_find(set, key, _yy_set_hash(set, key)) != NULL;
+}
+
+bool yy_set_add(yy_set_t *set, const void *key) {
+    return _yy_set_add_with_hash(set, key, _yy_set_hash(set, key));
+}
+
+bool yy_set_remove(yy_set_t *set, const void *key) {
+    yy_set_slot_t *slot;
+    
+    slot = _yy_set_find(set, key, _yy_set_hash(set, key));
+    if (slot == NULL) return false;
+    _yy_set_remove_slot(set, slot);
+    if (set->capacity > YY_SET_MIN_CAPACITY && set->count < set->capacity / 8) {
+        _yy_set_resize(set, set->capacity >> 1);
+    }
+    return true;
+}
+
+bool yy_set_clear(yy_set_t *set) {
+    _yy_set_release_keys(set);
+    memset(set->slots, 0, set->capacity * sizeof(yy_set_slot_t));
+    set->count = 0;
+    return true;
+}
+
+bool yy_set_reserve(yy_set_t *set, long count) {
+    long capacity;
+    
+    if (count < 0) {
+        yy_log_error("yy_set_t(%p):%s() count(%ld) cannot be less than zero", set, __func__, count);
+        return false;
+    }
+    capacity = _yy_set_capacity_for_count(count);
+    if (capacity <= set->capacity) return true;
+    return _yy_set_resize(set, capacity);
+}
+
+bool yy_set_get_all_keys(yy_set_t *set, const void **keys) {
+    long i;
+    
+    if (keys == NULL) return false;
+    for (i = 0; i < set->capacity; i++) {
+        if (set->slots[i].hash != YY_SET_EMPTY_HASH) *keys++ = set->slots[i].key;
+    }
+    return true;
+}
+
+bool yy_set_foreach(yy_set_t *set, yy_set_foreach_func func, void *context) {
+    long i;
+    
+    if (func == NULL) return false;
+    for (i = 0; i < set->capacity; i++) {
+        if (set->slots[i].hash != YY_SET_EMPTY_HASH) func(set->slots[i].key, context);
+    }
+    return true;
+}
+
+bool yy_set_union_into(yy_set_t *set, yy_set_t *other) {
+    yy_set_slot_t *slot;
+    long i;
+    
+    if (other == NULL) return false;
+    if (other == set) return true;
+    if (!yy_set_reserve(set, set->count + other->count)) return false;
+    for (i = 0; i < other->capacity; i++) {
+        slot = other->slots + i;
+        if (slot->hash == YY_SET_EMPTY_HASH) continue;
+        if (!_yy_set_add_with_hash(set, slot->key, _yy_set_rehash(set, other, slot))) return false;
+    }
+    return true;
+}
+
+yy_set_t *yy_set_intersect(yy_set_t *set1, yy_set_t *set2) {
+    yy_set_t *result, *small, *large;
+    yy_set_slot_t *slot, *found;
+    long i;
+    
+    if (set1 == NULL || set2 == NULL) {
+        yy_log_error("%s() input set cannot be null", __func__);
+        return NULL;
+    }
+    small = set1->count <= set2->count ? set1 : set2;
+    large = small == set1 ? set2 : set1;
+    result = yy_set_create_with_options(small->count, &set1->key_callback);
+    if (result == NULL) return NULL;
+    for (i = 0; i < small->capacity; i++) {
+        slot = small->slots + i;
+        if (slot->hash == YY_SET_EMPTY_HASH) continue;
+        found = _yy_set_find(large, slot->key, _yy_set_rehash(large, small, slot));
+        if (found == NULL) continue;
+        
+        /* keep the key (and hash) of set1 */
+        if (small == set2) slot = found;
+        if (!_yy_set_add_with_hash(result, slot->key, slot->hash)) {
+            yy_release(result);
+            return NULL;
+        }
+    }
+    return result;
+}
+
+yy_set_t *yy_set_difference(yy_set_t *set1, yy_set_t *set2) {
+    yy_set_t *result;
+    yy_set_slot_t *slot, *found;
+    long i;
+    
+    if (set1 == NULL || set2 == NULL) {
+        yy_log_error("%s() input set cannot be null", __func__);
+        return NULL;
+    }
+    if (set2->count < set1->count) {
+        /* copy set1 and remove the keys of the smaller set2 */
+        result = yy_set_create_copy(set1);
+        if (result == NULL) return NULL;
+        for (i = 0; i < set2->capacity && result->count > 0; i++) {
+            slot = set2->slots + i;
+            if (slot->hash == YY_SET_EMPTY_HASH) continue;
+            found = _yy_set_find(result, slot->key, _yy_set_rehash(result, set2, slot));
+            if (found) _yy_set_remove_slot(result, found);
+        }
+        return result;
+    }
+    result = yy_set_create_with_options(set1->count, &set1->key_callback);
+    if (result == NULL) return NULL;
+    for (i = 0; i < set1->capacity; i++) {
+        slot = set1->slots + i;
+        if (slot->hash == YY_SET_EMPTY_HASH) continue;
+        if (_yy_set_find(set2, slot->key, _yy_set_rehash(set2, set1, slot))) continue;
+        if (!_yy_set_add_with_hash(result, slot->key, slot->hash)) {
+            yy_release(result);
+            return NULL;
+        }
+    }
+    return result;
+}
+
+bool yy_set_is_subset(yy_set_t *set, yy_set_t *other) {
+    yy_set_slot_t *slot;
+    long i;
+    
+    if (other == NULL) return false;
+    if (set->count > other->count) return false;
+    for (i = 0; i < set->capacity; i++) {
+        slot = set->slots + i;
+        if (slot->hash == YY_SET_EMPTY_HASH) continue;
+        if (!_yy_set_find(other, slot->key, _yy_set_rehash(other, set, slot))) return false;
+    }
+    return true;
+}
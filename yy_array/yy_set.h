@@ -0,0 +1,71 @@
+//
+//  yy_set.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_set_h
+#define YYMidiBase_yy_set_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yy_base.h"
+#include "yy_array.h"
+#include "yy_map.h"
+
+/// Prototype of a callback function that may be applied to every key in a set.
+typedef void (*yy_set_foreach_func)(const void *key, void *context);
+
+/**
+ YY Set  (Similar to CFMutableSet)
+ 
+ Keys only, in an open addressing table of (key, hash) slots. The key
+ callbacks are the same as yy_map (yy_map_string_key_callback,
+ yy_map_object_key_callback...).
+ 
+ The set operations iterate the smaller set when they can, and reuse the
+ stored hashes when both sets use the same hash callback.
+ 
+ Example:
+ yy_set_t *set = yy_set_create_with_options(0, &yy_map_string_key_callback);
+ yy_set_add(set, "a");
+ yy_set_add(set, "b");
+ bool has_a = yy_set_contains(set, "a");
+ yy_release(set);
+ */
+typedef struct _yy_set yy_set_t;
+
+yy_set_t *yy_set_create();
+yy_set_t *yy_set_create_with_options(long capacity, const yy_map_key_callback_t *key_callback);
+yy_set_t *yy_set_create_copy(yy_set_t *set);
+/// Create a set of the values in array (duplicates are added once).
+yy_set_t *yy_set_create_with_array(yy_array_t *array, const yy_map_key_callback_t *key_callback);
+/// Create an array of the keys, with the retain/release/equal callbacks of the set.
+yy_array_t *yy_set_create_array(yy_set_t *set);
+
+long yy_set_count(yy_set_t *set);
+bool yy_set_contains(yy_set_t *set, const void *key);
+/// Returns false if the key cannot be added (already present is not an error).
+bool yy_set_add(yy_set_t *set, const void *key);
+bool yy_set_remove(yy_set_t *set, const void *key);
+bool yy_set_clear(yy_set_t *set);
+/// Make room for `count` keys without resizing.
+bool yy_set_reserve(yy_set_t *set, long count);
+bool yy_set_get_all_keys(yy_set_t *set, const void **keys);
+bool yy_set_foreach(yy_set_t *set, yy_set_foreach_func func, void *context);
+
+/// Add all the keys of `other` to `set`.
+bool yy_set_union_into(yy_set_t *set, yy_set_t *other);
+/// Create a set of the keys in both sets (with the callbacks of `set1`).
+yy_set_t *yy_set_intersect(yy_set_t *set1, yy_set_t *set2);
+/// Create a set of the keys in `set1` but not in `set2` (with the callbacks of `set1`).
+yy_set_t *yy_set_difference(yy_set_t *set1, yy_set_t *set2);
+/// Whether every key of `set` is in `other`.
+bool yy_set_is_subset(yy_set_t *set, yy_set_t *other);
+
+#endif
@@ -0,0 +1,781 @@
+//
+//  yy_sorted_map.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_sorted_map.h"
+#include "yy_log.h"
+#include "yy_base_private.h"
+
+#include <string.h>
+#include <limits.h>
+
+
+/// Max keys in a leaf, max children in an inner node.
+#define YY_SORTED_MAP_ORDER 32
+
+/// Min keys in a leaf, min children in an inner node (except the root).
+#define YY_SORTED_MAP_MIN (YY_SORTED_MAP_ORDER / 2)
+
+/// Fill count of the nodes built by bulk loading.
+#define YY_SORTED_MAP_FILL (YY_SORTED_MAP_ORDER * 3 / 4)
+
+
+typedef struct _yy_sorted_map_node  yy_sorted_map_node_t;
+typedef struct _yy_sorted_map_leaf  yy_sorted_map_leaf_t;
+typedef struct _yy_sorted_map_inner yy_sorted_map_inner_t;
+
+struct _yy_sorted_map_node {
+    bool leaf;
+    long count;     ///< keys count in leaf, children count in inner node
+};
+
+struct _yy_sorted_map_leaf {
+    yy_sorted_map_node_t head;
+    const void *keys[YY_SORTED_MAP_ORDER + 1];
+    const void *values[YY_SORTED_MAP_ORDER + 1];
+    yy_sorted_map_leaf_t *prev;
+    yy_sorted_map_leaf_t *next;
+};
+
+/*
+ keys[i] is the smallest key in children[i + 1], it always points to a key
+ owned by a leaf. sizes[i] is the pairs count of the subtree children[i].
+ */
+struct _yy_sorted_map_inner {
+    yy_sorted_map_node_t head;
+    const void *keys[YY_SORTED_MAP_ORDER];
+    yy_sorted_map_node_t *children[YY_SORTED_MAP_ORDER + 1];
+    long sizes[YY_SORTED_MAP_ORDER + 1];
+};
+
+struct _yy_sorted_map {
+    long count;
+    yy_sorted_map_node_t *root;
+    yy_sorted_map_leaf_t *first;
+    yy_sorted_map_leaf_t *last;
+    yy_comparator_func cmp;
+    void *context;
+    yy_map_key_callback_t key_callback;
+    yy_map_value_callback_t value_callback;
+};
+
+#define _yy_leaf(node)  ((yy_sorted_map_leaf_t *)(node))
+#define _yy_inner(node) ((yy_sorted_map_inner_t *)(node))
+
+
+
+/**
+ * First index whose key is not less than key.
+ */
+yy_inline long _yy_sorted_map_lower_bound(yy_sorted_map_t *map, const void **keys, long count, const void *key) {
+    long lo = 0, hi = count, mid;
+    while (lo < hi) {
+        mid = (lo + hi) >> 1;
+        if (map->cmp(keys[mid], key, map->context) == YY_ORDER_ASC) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * First index whose key is greater than key.
+ */
+yy_inline long _yy_sorted_map_upper_bound(yy_sorted_map_t *map, const void **keys, long count, const void *key) {
+    long lo = 0, hi = count, mid;
+    while (lo < hi) {
+        mid = (lo + hi) >> 1;
+        if (map->cmp(keys[mid], key, map->context) != YY_ORDER_DESC) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * Index of the child which may contain the key.
+ */
+yy_inline long _yy_sorted_map_route(yy_sorted_map_t *map, yy_sorted_map_inner_t *inner, const void *key) {
+    return _yy_sorted_map_upper_bound(map, inner->keys, inner->head.count - 1, key);
+}
+
+yy_inline yy_sorted_map_leaf_t * _yy_sorted_map_find_leaf(yy_sorted_map_t *map, const void *key) {
+    yy_sorted_map_node_t *node = map->root;
+    while (node && !node->leaf) {
+        node = _yy_inner(node)->children[_yy_sorted_map_route(map, _yy_inner(node), key)];
+    }
+    return _yy_leaf(node);
+}
+
+yy_inline long _yy_sorted_map_node_size(yy_sorted_map_node_t *node) {
+    long i, size;
+    if (node->leaf) return node->count;
+    size = 0;
+    for (i = 0; i < node->count; i++) size += _yy_inner(node)->sizes[i];
+    return size;
+}
+
+yy_inline const void * _yy_sorted_map_min_key(yy_sorted_map_node_t *node) {
+    while (!node->leaf) node = _yy_inner(node)->children[0];
+    return _yy_leaf(node)->keys[0];
+}
+
+static yy_sorted_map_node_t * _yy_sorted_map_node_create(bool leaf) {
+    yy_sorted_map_node_t *node;
+    size_t size;
+    
+    size = leaf ? sizeof(yy_sorted_map_leaf_t) : sizeof(yy_sorted_map_inner_t);
+    node = malloc(size);
+    if (node == NULL) {
+        yy_log_error("yy_sorted_map_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, size);
+        return NULL;
+    }
+    node->leaf = leaf;
+    node->count = 0;
+    if (leaf) {
+        _yy_leaf(node)->prev = NULL;
+        _yy_leaf(node)->next = NULL;
+    }
+    return node;
+}
+
+static void _yy_sorted_map_node_free(yy_sorted_map_t *map, yy_sorted_map_node_t *node) {
+    long i;
+    yy_sorted_map_leaf_t *leaf;
+    
+    if (node->leaf) {
+        leaf = _yy_leaf(node);
+        for (i = 0; i < node->count; i++) {
+            if (map->key_callback.release) map->key_callback.release(leaf->keys[i]);
+            if (map->value_callback.release) map->value_callback.release(leaf->values[i]);
+        }
+    } else {
+        for (i = 0; i < node->count; i++) {
+            _yy_sorted_map_node_free(map, _yy_inner(node)->children[i]);
+        }
+    }
+    free(node);
+}
+
+
+
+/******************************* insert ***************************************/
+
+/**
+ * Insert a pair into the subtree.
+ *
+ * @param split     set to the new right sibling if the node is split
+ * @param split_key set to the smallest key of the new right sibling
+ * @return -1 on error, 0 if an existing value was replaced, 1 if inserted
+ */
+static int _yy_sorted_map_insert(yy_sorted_map_t      *map,
+                                 yy_sorted_map_node_t *node,
+                                 const void           *key,
+                                 const void           *value,
+                                 yy_sorted_map_node_t **split,
+                                 const void           **split_key) {
+    yy_sorted_map_node_t *right, *child_split;
+    yy_sorted_map_leaf_t *leaf, *right_leaf;
+    yy_sorted_map_inner_t *inner, *right_inner;
+    const void *child_split_key;
+    long pos, move, total;
+    int result;
+    
+    *split = NULL;
+    if (node->leaf) {
+        leaf = _yy_leaf(node);
+        pos = _yy_sorted_map_lower_bound(map, leaf->keys, node->count, key);
+        if (pos < node->count && map->cmp(leaf->keys[pos], key, map->context) == YY_ORDER_EQUAL) {
+            if (map->value_callback.retain) value = map->value_callback.retain(value);
+            if (map->value_callback.release) map->value_callback.release(leaf->values[pos]);
+            leaf->values[pos] = value;
+            return 0;
+        }
+        
+        /* allocate before modify, so a failure leaves the tree untouched */
+        right = NULL;
+        if (node->count == YY_SORTED_MAP_ORDER) {
+            right = _yy_sorted_map_node_create(true);
+            if (right == NULL) return -1;
+        }
+        
+        memmove(leaf->keys + pos + 1, leaf->keys + pos, (node->count - pos) * sizeof(void *));
+        memmove(leaf->values + pos + 1, leaf->values + pos, (node->count - pos) * sizeof(void *));
+        if (map->key_callback.retain) key = map->key_callback.retain(key);
+        if (map->value_callback.retain) value = map->value_callback.retain(value);
+        leaf->keys[pos] = key;
+        leaf->values[pos] = value;
+        node->count++;
+        
+        if (right) {
+            right_leaf = _yy_leaf(right);
+            move = node->count / 2;
+            node->count -= move;
+            memcpy(right_leaf->keys, leaf->keys + node->count, move * sizeof(void *));
+            memcpy(right_leaf->values, leaf->values + node->count, move * sizeof(void *));
+            right->count = move;
+            
+            right_leaf->prev = leaf;
+            right_leaf->next = leaf->next;
+            if (leaf->next) leaf->next->prev = right_leaf;
+            else map->last = right_leaf;
+            leaf->next = right_leaf;
+            
+            *split = right;
+            *split_key = right_leaf->keys[0];
+        }
+        return 1;
+    }
+    
+    inner = _yy_inner(node);
+    right = NULL;
+    if (node->count == YY_SORTED_MAP_ORDER) {
+        right = _yy_sorted_map_node_create(false);
+        if (right == NULL) return -1;
+    }
+    
+    pos = _yy_sorted_map_route(map, inner, key);
+    result = _yy_sorted_map_insert(map, inner->children[pos], key, value, &child_split, &child_split_key);
+    if (result == 1) inner->sizes[pos]++;
+    
+    if (child_split) {
+        memmove(inner->keys + pos + 1, inner->keys + pos, (node->count - 1 - pos) * sizeof(void *));
+        memmove(inner->children + pos + 2, inner->children + pos + 1, (node->count - 1 - pos) * sizeof(void *));
+        memmove(inner->sizes + pos + 2, inner->sizes + pos + 1, (node->count - 1 - pos) * sizeof(long));
+        total = inner->sizes[pos];
+        inner->keys[pos] = child_split_key;
+        inner->children[pos + 1] = child_split;
+        inner->sizes[pos] = _yy_sorted_map_node_size(inner->children[pos]);
+        inner->sizes[pos + 1] = total - inner->sizes[pos];
+        node->count++;
+    }
+    
+    if (node->count > YY_SORTED_MAP_ORDER) {
+        /* left keeps `node->count - move` children, the middle key moves up */
+        right_inner = _yy_inner(right);
+        move = node->count / 2;
+        node->count -= move;
+        memcpy(right_inner->keys, inner->keys + node->count, (move - 1) * sizeof(void *));
+        memcpy(right_inner->children, inner->children + node->count, move * sizeof(void *));
+        memcpy(right_inner->sizes, inner->sizes + node->count, move * sizeof(long));
+        right->count = move;
+        *split = right;
+        *split_key = inner->keys[node->count - 1];
+    } else if (right) {
+        free(right);
+    }
+    return result;
+}
+
+
+
+/******************************* remove ***************************************/
+
+static void _yy_sorted_map_merge(yy_sorted_map_t *map, yy_sorted_map_inner_t *parent, long index) {
+    yy_sorted_map_node_t *left, *right;
+    yy_sorted_map_leaf_t *left_leaf, *right_leaf;
+    yy_sorted_map_inner_t *left_inner, *right_inner;
+    
+    left = parent->children[index];
+    right = parent->children[index + 1];
+    if (left->leaf) {
+        left_leaf = _yy_leaf(left);
+        right_leaf = _yy_leaf(right);
+        memcpy(left_leaf->keys + left->count, right_leaf->keys, right->count * sizeof(void *));
+        memcpy(left_leaf->values + left->count, right_leaf->values, right->count * sizeof(void *));
+        left_leaf->next = right_leaf->next;
+        if (right_leaf->next) right_leaf->next->prev = left_leaf;
+        else map->last = left_leaf;
+    } else {
+        left_inner = _yy_inner(left);
+        right_inner = _yy_inner(right);
+        left_inner->keys[left->count - 1] = parent->keys[index];
+        memcpy(left_inner->keys + left->count, right_inner->keys, (right->count - 1) * sizeof(void *));
+        memcpy(left_inner->children + left->count, right_inner->children, right->count * sizeof(void *));
+        memcpy(left_inner->sizes + left->count, right_inner->sizes, right->count * sizeof(long));
+    }
+    left->count += right->count;
+    free(right);
+    
+    parent->sizes[index] += parent->sizes[index + 1];
+    memmove(parent->keys + index, parent->keys + index + 1,
+            (parent->head.count - 2 - index) * sizeof(void *));
+    memmove(parent->children + index + 1, parent->children + index + 2,
+            (parent->head.count - 2 - index) * sizeof(void *));
+    memmove(parent->sizes + index + 1, parent->sizes + index + 2,
+            (parent->head.count - 2 - index) * sizeof(long));
+    parent->head.count--;
+}
+
+/**
+ * Fix the underflow of parent->children[index] by borrowing from or merging
+ * with a sibling.
+ */
+static void _yy_sorted_map_rebalance(yy_sorted_map_t *map, yy_sorted_map_inner_t *parent, long index) {
+    yy_sorted_map_node_t *child, *left, *right;
+    yy_sorted_map_leaf_t *c_leaf, *s_leaf;
+    yy_sorted_map_inner_t *c_inner, *s_inner;
+    long moved;
+    
+    child = parent->children[index];
+    left = index > 0 ? parent->children[index - 1] : NULL;
+    right = index + 1 < parent->head.count ? parent->children[index + 1] : NULL;
+    
+    if (left && left->count > YY_SORTED_MAP_MIN) {
+        /* borrow the last entry of the left sibling */
+        if (child->leaf) {
+            c_leaf = _yy_leaf(child);
+            s_leaf = _yy_leaf(left);
+            memmove(c_leaf->keys + 1, c_leaf->keys, child->count * sizeof(void *));
+            memmove(c_leaf->values + 1, c_leaf->values, child->count * sizeof(void *));
+            c_leaf->keys[0] = s_leaf->keys[left->count - 1];
+            c_leaf->values[0] = s_leaf->values[left->count - 1];
+            parent->keys[index - 1] = c_leaf->keys[0];
+            moved = 1;
+        } else {
+            c_inner = _yy_inner(child);
+            s_inner = _yy_inner(left);
+            memmove(c_inner->keys + 1, c_inner->keys, (child->count - 1) * sizeof(void *));
+            memmove(c_inner->children + 1, c_inner->children, child->count * sizeof(void *));
+            memmove(c_inner->sizes + 1, c_inner->sizes, child->count * sizeof(long));
+            c_inner->keys[0] = parent->keys[index - 1];
+            c_inner->children[0] = s_inner->children[left->count - 1];
+            c_inner->sizes[0] = s_inner->sizes[left->count - 1];
+            parent->keys[index - 1] = s_inner->keys[left->count - 2];
+            moved = c_inner->sizes[0];
+        }
+        left->count--;
+        child->count++;
+        parent->sizes[index - 1] -= moved;
+        parent->sizes[index] += moved;
+    } else if (right && right->count > YY_SORTED_MAP_MIN) {
+        /* borrow the first entry of the right sibling */
+        if (child->leaf) {
+            c_leaf = _yy_leaf(child);
+            s_leaf = _yy_leaf(right);
+            c_leaf->keys[child->count] = s_leaf->keys[0];
+            c_leaf->values[child->count] = s_leaf->values[0];
+            memmove(s_leaf->keys, s_leaf->keys + 1, (right->count - 1) * sizeof(void *));
+            memmove(s_leaf->values, s_leaf->values + 1, (right->count - 1) * sizeof(void *));
+            parent->keys[index] = s_leaf->keys[0];
+            moved = 1;
+        } else {
+            c_inner = _yy_inner(child);
+            s_inner = _yy_inner(right);
+            c_inner->keys[child->count - 1] = parent->keys[index];
+            c_inner->children[child->count] = s_inner->children[0];
+            c_inner->sizes[child->count] = s_inner->sizes[0];
+            parent->keys[index] = s_inner->keys[0];
+            moved = s_inner->sizes[0];
+            memmove(s_inner->keys, s_inner->keys + 1, (right->count - 2) * sizeof(void *));
+            memmove(s_inner->children, s_inner->children + 1, (right->count - 1) * sizeof(void *));
+            memmove(s_inner->sizes, s_inner->sizes + 1, (right->count - 1) * sizeof(long));
+        }
+        right->count--;
+        child->count++;
+        parent->sizes[index + 1] -= moved;
+        parent->sizes[index] += moved;
+    } else if (left) {
+        _yy_sorted_map_merge(map, parent, index - 1);
+    } else if (right) {
+        _yy_sorted_map_merge(map, parent, index);
+    }
+}
+
+static bool _yy_sorted_map_remove(yy_sorted_map_t *map, yy_sorted_map_node_t *node, const void *key) {
+    yy_sorted_map_leaf_t *leaf;
+    yy_sorted_map_inner_t *inner;
+    long pos;
+    
+    if (node->leaf) {
+        leaf = _yy_leaf(node);
+        pos = _yy_sorted_map_lower_bound(map, leaf->keys, node->count, key);
+        if (pos >= node->count || map->cmp(leaf->keys[pos], key, map->context) != YY_ORDER_EQUAL) {
+            return false;
+        }
+        if (map->key_callback.release) map->key_callback.release(leaf->keys[pos]);
+        if (map->value_callback.release) map->value_callback.release(leaf->values[pos]);
+        memmove(leaf->keys + pos, leaf->keys + pos + 1, (node->count - pos - 1) * sizeof(void *));
+        memmove(leaf->values + pos, leaf->values + pos + 1, (node->count - pos - 1) * sizeof(void *));
+        node->count--;
+        return true;
+    }
+    
+    inner = _yy_inner(node);
+    pos = _yy_sorted_map_route(map, inner, key);
+    if (!_yy_sorted_map_remove(map, inner->children[pos], key)) return false;
+    inner->sizes[pos]--;
+    
+    /* the separator may point to the released key, refresh it */
+    if (pos > 0 && inner->children[pos]->count > 0) {
+        inner->keys[pos - 1] = _yy_sorted_map_min_key(inner->children[pos]);
+    }
+    if (inner->children[pos]->count < YY_SORTED_MAP_MIN) {
+        _yy_sorted_map_rebalance(map, inner, pos);
+    }
+    return true;
+}
+
+
+
+/******************************* bulk load ************************************/
+
+/**
+ * Number of parents for `count` children, so that every parent holds
+ * between YY_SORTED_MAP_MIN and YY_SORTED_MAP_ORDER children.
+ */
+yy_inline long _yy_sorted_map_parent_count(long count) {
+    long parents = (count + YY_SORTED_MAP_FILL - 1) / YY_SORTED_MAP_FILL;
+    while (parents > 1 && count / parents < YY_SORTED_MAP_MIN) parents--;
+    return parents;
+}
+
+/**
+ * Build a tree of the (sorted, not empty) pairs and swap it in for the map's
+ * tree. The map is left untouched on failure.
+ */
+static bool _yy_sorted_map_build(yy_sorted_map_t *map, yy_array_t *keys, yy_array_t *values) {
+    yy_sorted_map_node_t **level, *node;
+    yy_sorted_map_leaf_t *leaf, *first, *prev;
+    long *sizes;
+    long count, nodes, i, j, loc, length;
+    
+    count = yy_array_count(keys);
+    nodes = _yy_sorted_map_parent_count(count);
+    level = malloc(nodes * sizeof(void *));
+    sizes = malloc(nodes * sizeof(long));
+    if (level == NULL || sizes == NULL) {
+        yy_log_error("yy_sorted_map_t(%p):%s() attempt to allocate %ld bytes failed",
+                     map, __func__, nodes * (sizeof(void *) + sizeof(long)));
+        free(level);
+        free(sizes);
+        return false;
+    }
+    
+    /* leaves, filled evenly and linked */
+    first = prev = NULL;
+    loc = 0;
+    for (i = 0; i < nodes; i++) {
+        node = _yy_sorted_map_node_create(true);
+        if (node == NULL) {
+            count = loc = 0;
+            goto fail;
+        }
+        leaf = _yy_leaf(node);
+        length = count / nodes + (i < count % nodes ? 1 : 0);
+        yy_array_get_range(keys, yy_range_make(loc, length), leaf->keys);
+        if (values) {
+            yy_array_get_range(values, yy_range_make(loc, length), leaf->values);
+        } else {
+            memset(leaf->values, 0, length * sizeof(void *));
+        }
+        for (j = 0; j < length; j++) {
+            if (map->key_callback.retain) leaf->keys[j] = map->key_callback.retain(leaf->keys[j]);
+            if (map->value_callback.retain) leaf->values[j] = map->value_callback.retain(leaf->values[j]);
+        }
+        node->count = length;
+        leaf->prev = prev;
+        if (prev) prev->next = leaf;
+        else first = leaf;
+        prev = leaf;
+        level[i] = node;
+        sizes[i] = length;
+        loc += length;
+    }
+    
+    /* inner levels, built in place over the level below */
+    while (nodes > 1) {
+        count = nodes;
+        nodes = _yy_sorted_map_parent_count(count);
+        loc = 0;
+        for (i = 0; i < nodes; i++) {
+            node = _yy_sorted_map_node_create(false);
+            if (node == NULL) goto fail;
+            length = count / nodes + (i < count % nodes ? 1 : 0);
+            for (j = 0; j < length; j++) {
+                _yy_inner(node)->children[j] = level[loc + j];
+                _yy_inner(node)->sizes[j] = sizes[loc + j];
+                if (j > 0) _yy_inner(node)->keys[j - 1] = _yy_sorted_map_min_key(level[loc + j]);
+            }
+            node->count = length;
+            loc += length;
+            level[i] = node;
+            sizes[i] = _yy_sorted_map_node_size(node);
+        }
+    }
+    yy_sorted_map_clear(map);
+    map->root = level[0];
+    map->first = first;
+    map->last = prev;
+    map->count = yy_array_count(keys);
+    free(level);
+    free(sizes);
+    return true;
+
+fail:
+    /* level[0, i) are the built nodes, level[loc, count) the ones not adopted yet */
+    for (j = 0; j < i; j++) _yy_sorted_map_node_free(map, level[j]);
+    for (j = loc; j < count; j++) _yy_sorted_map_node_free(map, level[j]);
+    free(level);
+    free(sizes);
+    return false;
+}
+
+
+
+/******************************* public ***************************************/
+
+static void _yy_sorted_map_dealloc(yy_sorted_map_t *map) {
+    yy_sorted_map_clear(map);
+    yy_dealloc(map);
+}
+
+yy_sorted_map_t *yy_sorted_map_create(yy_comparator_func cmp, void *context) {
+    return yy_sorted_map_create_with_options(cmp, context, NULL, NULL);
+}
+
+yy_sorted_map_t *yy_sorted_map_create_with_options(yy_comparator_func            cmp,
+                                                   void                          *context,
+                                                   const yy_map_key_callback_t   *key_callback,
+                                                   const yy_map_value_callback_t *value_callback) {
+    yy_sorted_map_t *map;
+    
+    if (cmp == NULL) {
+        yy_log_error("%s() comparator cannot be null",
+                     __func__);
+        return NULL;
+    }
+    
+    map = yy_alloc(yy_sorted_map_t, _yy_sorted_map_dealloc);
+    if (map == NULL) {
+        yy_log_error("yy_sorted_map_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_sorted_map_t));
+        return NULL;
+    }
+    map->cmp = cmp;
+    map->context = context;
+    if (key_callback) map->key_callback = *key_callback;
+    if (value_callback) map->value_callback = *value_callback;
+    return map;
+}
+
+long yy_sorted_map_count(yy_sorted_map_t *map) {
+    return map->count;
+}
+
+bool yy_sorted_map_contains_key(yy_sorted_map_t *map, const void *key) {
+    yy_sorted_map_leaf_t *leaf;
+    long pos;
+    
+    leaf = _yy_sorted_map_find_leaf(map, key);
+    if (leaf == NULL) return false;
+    pos = _yy_sorted_map_lower_bound(map, leaf->keys, leaf->head.count, key);
+    return pos < leaf->head.count && map->cmp(leaf->keys[pos], key, map->context) == YY_ORDER_EQUAL;
+}
+
+const void *yy_sorted_map_get(yy_sorted_map_t *map, const void *key) {
+    yy_sorted_map_leaf_t *leaf;
+    long pos;
+    
+    leaf = _yy_sorted_map_find_leaf(map, key);
+    if (leaf == NULL) return NULL;
+    pos = _yy_sorted_map_lower_bound(map, leaf->keys, leaf->head.count, key);
+    if (pos < leaf->head.count && map->cmp(leaf->keys[pos], key, map->context) == YY_ORDER_EQUAL) {
+        return leaf->values[pos];
+    }
+    return NULL;
+}
+
+bool yy_sorted_map_set(yy_sorted_map_t *map, const void *key, const void *value) {
+    yy_sorted_map_node_t *split, *root;
+    const void *split_key;
+    int result;
+    
+    if (map->root == NULL) {
+        map->root = _yy_sorted_map_node_create(true);
+        if (map->root == NULL) return false;
+        map->first = map->last = _yy_leaf(map->root);
+    }
+    
+    /* a full root may split, allocate the new root first */
+    root = NULL;
+    if (map->root->count == YY_SORTED_MAP_ORDER) {
+        root = _yy_sorted_map_node_create(false);
+        if (root == NULL) return false;
+    }
+    
+    result = _yy_sorted_map_insert(map, map->root, key, value, &split, &split_key);
+    if (result == 1) map->count++;
+    
+    if (split) {
+        _yy_inner(root)->children[0] = map->root;
+        _yy_inner(root)->children[1] = split;
+        _yy_inner(root)->keys[0] = split_key;
+        _yy_inner(root)->sizes[1] = _yy_sorted_map_node_size(split);
+        _yy_inner(root)->sizes[0] = map->count - _yy_inner(root)->sizes[1];
+        root->count = 2;
+        map->root = root;
+    } else if (root) {
+        free(root);
+    }
+    return result >= 0;
+}
+
+bool yy_sorted_map_remove(yy_sorted_map_t *map, const void *key) {
+    yy_sorted_map_node_t *root;
+    
+    if (map->root == NULL) return false;
+    if (!_yy_sorted_map_remove(map, map->root, key)) return false;
+    map->count--;
+    
+    root = map->root;
+    if (!root->leaf && root->count == 1) {
+        map->root = _yy_inner(root)->children[0];
+        free(root);
+    } else if (root->leaf && root->count == 0) {
+        free(root);
+        map->root = NULL;
+        map->first = map->last = NULL;
+    }
+    return true;
+}
+
+bool yy_sorted_map_clear(yy_sorted_map_t *map) {
+    if (map->root) {
+        _yy_sorted_map_node_free(map, map->root);
+    }
+    map->root = NULL;
+    map->first = map->last = NULL;
+    map->count = 0;
+    return true;
+}
+
+bool yy_sorted_map_floor(yy_sorted_map_t *map, const void *key, const void **out_key, const void **out_value) {
+    yy_sorted_map_leaf_t *leaf;
+    long pos;
+    
+    leaf = _yy_sorted_map_find_leaf(map, key);
+    if (leaf == NULL) return false;
+    pos = _yy_sorted_map_upper_bound(map, leaf->keys, leaf->head.count, key);
+    if (pos == 0) {
+        leaf = leaf->prev;
+        if (leaf == NULL) return false;
+        pos = leaf->head.count;
+    }
+    if (out_key) *out_key = leaf->keys[pos - 1];
+    if (out_value) *out_value = leaf->values[pos - 1];
+    return true;
+}
+
+bool yy_sorted_map_ceiling(yy_sorted_map_t *map, const void *key, const void **out_key, const void **out_value) {
+    yy_sorted_map_leaf_t *leaf;
+    long pos;
+    
+    leaf = _yy_sorted_map_find_leaf(map, key);
+    if (leaf == NULL) return false;
+    pos = _yy_sorted_map_lower_bound(map, leaf->keys, leaf->head.count, key);
+    if (pos == leaf->head.count) {
+        leaf = leaf->next;
+        if (leaf == NULL) return false;
+        pos = 0;
+    }
+    if (out_key) *out_key = leaf->keys[pos];
+    if (out_value) *out_value = leaf->values[pos];
+    return true;
+}
+
+long yy_sorted_map_rank(yy_sorted_map_t *map, const void *key) {
+    yy_sorted_map_node_t *node;
+    long i, pos, rank;
+    
+    rank = 0;
+    node = map->root;
+    if (node == NULL) return 0;
+    while (!node->leaf) {
+        pos = _yy_sorted_map_route(map, _yy_inner(node), key);
+        for (i = 0; i < pos; i++) rank += _yy_inner(node)->sizes[i];
+        node = _yy_inner(node)->children[pos];
+    }
+    return rank + _yy_sorted_map_lower_bound(map, _yy_leaf(node)->keys, node->count, key);
+}
+
+bool yy_sorted_map_select(yy_sorted_map_t *map, long rank, const void **out_key, const void **out_value) {
+    yy_sorted_map_node_t *node;
+    long i;
+    
+    if (rank < 0 || rank >= map->count) {
+        yy_log_error("yy_sorted_map_t(%p):%s() rank(%ld) out of bounds(0,%ld)",
+                     map, __func__, rank, map->count - 1);
+        return false;
+    }
+    node = map->root;
+    while (!node->leaf) {
+        for (i = 0; rank >= _yy_inner(node)->sizes[i]; i++) {
+            rank -= _yy_inner(node)->sizes[i];
+        }
+        node = _yy_inner(node)->children[i];
+    }
+    if (out_key) *out_key = _yy_leaf(node)->keys[rank];
+    if (out_value) *out_value = _yy_leaf(node)->values[rank];
+    return true;
+}
+
+bool yy_sorted_map_foreach(yy_sorted_map_t *map, yy_map_foreach_func func, void *context) {
+    yy_sorted_map_leaf_t *leaf;
+    long i;
+    
+    if (func == NULL) return false;
+    for (leaf = map->first; leaf; leaf = leaf->next) {
+        for (i = 0; i < leaf->head.count; i++) {
+            func(leaf->keys[i], leaf->values[i], context);
+        }
+    }
+    return true;
+}
+
+bool yy_sorted_map_foreach_range(yy_sorted_map_t *map, const void *low, const void *high,
+                                 yy_map_foreach_func func, void *context) {
+    yy_sorted_map_leaf_t *leaf;
+    long i;
+    
+    if (func == NULL) return false;
+    if (map->cmp(low, high, map->context) != YY_ORDER_ASC) return true;
+    
+    leaf = _yy_sorted_map_find_leaf(map, low);
+    if (leaf == NULL) return true;
+    i = _yy_sorted_map_lower_bound(map, leaf->keys, leaf->head.count, low);
+    for (; leaf; leaf = leaf->next, i = 0) {
+        for (; i < leaf->head.count; i++) {
+            if (map->cmp(leaf->keys[i], high, map->context) != YY_ORDER_ASC) return true;
+            func(leaf->keys[i], leaf->values[i], context);
+        }
+    }
+    return true;
+}
+
+bool yy_sorted_map_load(yy_sorted_map_t *map, yy_array_t *keys, yy_array_t *values) {
+    long i, count;
+    const void *prev, *key;
+    
+    if (keys == NULL) return false;
+    count = yy_array_count(keys);
+    if (values && yy_array_count(values) != count) {
+        yy_log_error("yy_sorted_map_t(%p):%s() values count(%ld) does not match keys count(%ld)",
+                     map, __func__, yy_array_count(values), count);
+        return false;
+    }
+    for (i = 1, prev = count > 0 ? yy_array_get(keys, 0) : NULL; i < count; i++, prev = key) {
+        key = yy_array_get(keys, i);
+        if (map->cmp(prev, key, map->context) != YY_ORDER_ASC) {
+            yy_log_error("yy_sorted_map_t(%p):%s() keys are not strictly ascending at index(%ld)",
+                         map, __func__, i);
+            return false;
+        }
+    }
+    
+    if (count == 0) return yy_sorted_map_clear(map);
+    return _yy_sorted_map_build(map, keys, values);
+}
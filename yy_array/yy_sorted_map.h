@@ -0,0 +1,76 @@
+//
+//  yy_sorted_map.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_sorted_map_h
+#define YYMidiBase_yy_sorted_map_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yy_base.h"
+#include "yy_array.h"
+#include "yy_map.h"
+
+
+/**
+ YY Sorted Map  (B+ tree, keys are kept in comparator order)
+
+ Uses the same key/value callbacks as yy_map, the `hash` and `equal` key
+ callbacks are ignored: keys are compared with the comparator only.
+
+ Example:
+
+ yy_sorted_map_t *map = yy_sorted_map_create(my_time_cmp, NULL);
+ yy_sorted_map_set(map, (void *)100, event1);
+ yy_sorted_map_set(map, (void *)200, event2);
+ yy_sorted_map_foreach_range(map, (void *)0, (void *)150, func, NULL);
+ yy_release(map);
+ */
+typedef struct _yy_sorted_map yy_sorted_map_t;
+
+yy_sorted_map_t *yy_sorted_map_create(yy_comparator_func cmp, void *context);
+yy_sorted_map_t *yy_sorted_map_create_with_options(yy_comparator_func            cmp,
+                                                   void                          *context,
+                                                   const yy_map_key_callback_t   *key_callback,
+                                                   const yy_map_value_callback_t *value_callback);
+
+long yy_sorted_map_count(yy_sorted_map_t *map);
+bool yy_sorted_map_contains_key(yy_sorted_map_t *map, const void *key);
+const void *yy_sorted_map_get(yy_sorted_map_t *map, const void *key);
+bool yy_sorted_map_set(yy_sorted_map_t *map, const void *key, const void *value);
+bool yy_sorted_map_remove(yy_sorted_map_t *map, const void *key);
+bool yy_sorted_map_clear(yy_sorted_map_t *map);
+
+/// Find the greatest key less than or equal to `key`. out_key/out_value can be NULL.
+bool yy_sorted_map_floor(yy_sorted_map_t *map, const void *key, const void **out_key, const void **out_value);
+/// Find the least key greater than or equal to `key`. out_key/out_value can be NULL.
+bool yy_sorted_map_ceiling(yy_sorted_map_t *map, const void *key, const void **out_key, const void **out_value);
+
+/// Number of keys less than `key`.
+long yy_sorted_map_rank(yy_sorted_map_t *map, const void *key);
+/// Get the pair at sorted position `rank` (0 is the smallest key). out_key/out_value can be NULL.
+bool yy_sorted_map_select(yy_sorted_map_t *map, long rank, const void **out_key, const void **out_value);
+
+/// Apply func to every pair in ascending key order.
+bool yy_sorted_map_foreach(yy_sorted_map_t *map, yy_map_foreach_func func, void *context);
+/// Apply func to the pairs with low <= key < high in ascending key order.
+bool yy_sorted_map_foreach_range(yy_sorted_map_t *map, const void *low, const void *high,
+                                 yy_map_foreach_func func, void *context);
+
+/**
+ Replace the content of the map with the keys of a sorted array in O(n).
+
+ @param keys   strictly ascending keys (checked with the comparator)
+ @param values values for each key, or NULL to set all values to NULL
+ @return false on failure, the map keeps its content then
+ */
+bool yy_sorted_map_load(yy_sorted_map_t *map, yy_array_t *keys, yy_array_t *values);
+
+#endif
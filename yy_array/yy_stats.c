@@ -0,0 +1,68 @@
+//
+//  yy_stats.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_stats.h"
+#include "yy_stats_private.h"
+
+yy_stats_t _yy_stats_global;
+
+bool yy_stats_enabled() {
+#ifdef YY_ENABLE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void yy_stats_get_global(yy_stats_t *stats) {
+    unsigned long *dst = (unsigned long *)stats;
+    unsigned long *src = (unsigned long *)&_yy_stats_global;
+    size_t i;
+    
+    if (stats == NULL) return;
+    for (i = 0; i < sizeof(yy_stats_t) / sizeof(unsigned long); i++) {
+        dst[i] = __atomic_load_n(src + i, __ATOMIC_RELAXED);
+    }
+}
+
+void yy_stats_reset_global() {
+    unsigned long *src = (unsigned long *)&_yy_stats_global;
+    size_t i;
+    
+    for (i = 0; i < sizeof(yy_stats_t) / sizeof(unsigned long); i++) {
+        __atomic_store_n(src + i, 0, __ATOMIC_RELAXED);
+    }
+}
+
+static void _yy_stats_dump_line(FILE *file, const char *name, unsigned long count, unsigned long bytes, bool has_bytes) {
+    if (has_bytes) {
+        fprintf(file, "  %-22s %12lu %14.3f KB\n", name, count, bytes / 1024.0);
+    } else {
+        fprintf(file, "  %-22s %12lu\n", name, count);
+    }
+}
+
+void yy_stats_dump(FILE *file, const char *name, const yy_stats_t *stats) {
+    yy_stats_t global;
+    
+    if (file == NULL) file = stdout;
+    if (stats == NULL) {
+        yy_stats_get_global(&global);
+        stats = &global;
+    }
+    fprintf(file, "yy_stats %s%s\n", name ? name : "", yy_stats_enabled() ? "" : " (disabled, build with YY_ENABLE_STATS)");
+    _yy_stats_dump_line(file, "reallocs", stats->reallocs, stats->realloc_bytes, true);
+    _yy_stats_dump_line(file, "moves", stats->moves, stats->moved_bytes, true);
+    _yy_stats_dump_line(file, "sorts", stats->sorts, 0, false);
+    _yy_stats_dump_line(file, "sort wraps", stats->sort_wraps, 0, false);
+    _yy_stats_dump_line(file, "sort linearizations", stats->sort_linearizations, 0, false);
+    _yy_stats_dump_line(file, "compares", stats->compares, 0, false);
+    if (stats->sorts > 0) {
+        fprintf(file, "  %-22s %12.1f\n", "compares per sort", (double)stats->compares / stats->sorts);
+    }
+}
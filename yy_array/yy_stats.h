@@ -0,0 +1,51 @@
+//
+//  yy_stats.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_stats_h
+#define YYMidiBase_yy_stats_h
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "yy_base.h"
+
+/**
+ Performance counters of the containers.
+ 
+ The counters are updated only when the library is built with YY_ENABLE_STATS
+ defined, otherwise they cost nothing and read as zero. Every container keeps
+ its own counters, the global counters add up all the containers.
+ 
+ Example:
+ yy_stats_t stats;
+ yy_array_get_stats(array, &stats);
+ yy_stats_dump(stdout, "tracks", &stats);
+ yy_stats_dump(stdout, "global", NULL);
+ */
+typedef struct _yy_stats {
+    unsigned long reallocs;             ///< rings allocated (first use, growth, copy on write)
+    unsigned long realloc_bytes;        ///< bytes of these rings
+    unsigned long moves;                ///< values shifted inside a ring
+    unsigned long moved_bytes;          ///< bytes of these values
+    unsigned long sorts;                ///< sorted ranges (longer than 1)
+    unsigned long sort_wraps;           ///< sorted ranges that crossed the end of the ring
+    unsigned long sort_linearizations;  ///< sorts that shifted values first (wrap or gap)
+    unsigned long compares;             ///< comparator calls of the sorts
+} yy_stats_t;
+
+/// Whether the library was built with YY_ENABLE_STATS.
+bool yy_stats_enabled();
+
+/// Counters of all the containers (since the last reset).
+void yy_stats_get_global(yy_stats_t *stats);
+void yy_stats_reset_global();
+
+/// Print a report of stats (the global counters if NULL) to file (stdout if NULL).
+void yy_stats_dump(FILE *file, const char *name, const yy_stats_t *stats);
+
+#endif
@@ -0,0 +1,31 @@
+//
+//  yy_stats_private.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_stats_private_h
+#define YYMidiBase_yy_stats_private_h
+
+#include "yy_stats.h"
+
+#ifdef YY_ENABLE_STATS
+
+extern yy_stats_t _yy_stats_global;
+
+/// Add n to a counter of a container and to the global counter.
+#define YY_STATS_ADD(stats, field, n) do { \
+    unsigned long _yy_stats_n = (unsigned long)(n); \
+    (stats)->field += _yy_stats_n; \
+    __atomic_add_fetch(&_yy_stats_global.field, _yy_stats_n, __ATOMIC_RELAXED); \
+} while (0)
+
+#else
+
+#define YY_STATS_ADD(stats, field, n) do { } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,346 @@
+//
+//  yy_string_array.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_string_array.h"
+#include "yy_base_private.h"
+#include "yy_log.h"
+#include "yy_sort.h"
+
+#include <string.h>
+#include <limits.h>
+
+#define YY_STRING_ARRAY_MIN_COUNT 16
+#define YY_STRING_ARRAY_MIN_BYTES 256
+
+/// Compact automatically when more than this many bytes (and half of the buffer) are unused.
+#define YY_STRING_ARRAY_COMPACT_BYTES 4096
+
+typedef struct _yy_string_entry {
+    uint64_t prefix;    ///< first 8 bytes, big endian, zero padded
+    uint64_t offset;    ///< offset in the buffer
+    uint32_t length;    ///< length in bytes (without the NUL)
+    uint32_t hash;
+} yy_string_entry_t;
+
+struct _yy_string_array {
+    long count;
+    long capacity;
+    yy_string_entry_t *entries;
+    char *bytes;
+    long byte_count;
+    long byte_capacity;
+    long garbage;       ///< bytes of removed strings
+};
+
+/**
+ * FNV-1a
+ */
+yy_inline uint32_t _yy_string_array_hash(const char *string, long length) {
+    const unsigned char *p = (const unsigned char *)string;
+    uint32_t hash = 2166136261U;
+    long i;
+    
+    for (i = 0; i < length; i++) {
+        hash = (hash ^ p[i]) * 16777619U;
+    }
+    return hash;
+}
+
+yy_inline uint64_t _yy_string_array_prefix(const char *string, long length) {
+    const unsigned char *p = (const unsigned char *)string;
+    uint64_t prefix = 0;
+    long i;
+    
+    for (i = 0; i < 8; i++) {
+        prefix = (prefix << 8) | (i < length ? p[i] : 0);
+    }
+    return prefix;
+}
+
+yy_inline bool _yy_string_array_validate_index(yy_string_array_t *array, long index, const char *func) {
+    if (index < 0 || index >= array->count) {
+        yy_log_error("yy_string_array_t(%p):%s() index(%ld) out of bounds(0,%ld)",
+                     array, func, index, array->count - 1);
+        return false;
+    }
+    return true;
+}
+
+static bool _yy_string_array_reserve(yy_string_array_t *array, long count, long byte_count) {
+    yy_string_entry_t *entries;
+    char *bytes;
+    long capacity;
+    
+    if (count > array->capacity) {
+        capacity = YY_MAX(array->capacity, YY_STRING_ARRAY_MIN_COUNT);
+        while (capacity < count) capacity <<= 1;
+        entries = realloc(array->entries, capacity * sizeof(yy_string_entry_t));
+        if (entries == NULL) {
+            yy_log_error("yy_string_array_t(%p):%s() attempt to allocate %ld bytes failed",
+                         array, __func__, capacity * sizeof(yy_string_entry_t));
+            return false;
+        }
+        array->entries = entries;
+        array->capacity = capacity;
+    }
+    if (byte_count > array->byte_capacity) {
+        capacity = YY_MAX(array->byte_capacity, YY_STRING_ARRAY_MIN_BYTES);
+        while (capacity < byte_count) capacity <<= 1;
+        bytes = realloc(array->bytes, capacity);
+        if (bytes == NULL) {
+            yy_log_error("yy_string_array_t(%p):%s() attempt to allocate %ld bytes failed",
+                         array, __func__, capacity);
+            return false;
+        }
+        array->bytes = bytes;
+        array->byte_capacity = capacity;
+    }
+    YY_REGISTRY_SET_BYTES(array, yy_string_array_get_memory_size(array));
+    return true;
+}
+
+static void _yy_string_array_dealloc(yy_string_array_t *array) {
+    free(array->entries);
+    free(array->bytes);
+    yy_dealloc(array);
+}
+
+yy_string_array_t * yy_string_array_create() {
+    return yy_string_array_create_with_capacity(0, 0);
+}
+
+yy_string_array_t * yy_string_array_create_with_capacity(long count, long byte_count) {
+    yy_string_array_t *array;
+    
+    if (count < 0 || byte_count < 0) {
+        yy_log_error("%s() count(%ld) and byte_count(%ld) cannot be less than zero",
+                     __func__, count, byte_count);
+        return NULL;
+    }
+    array = yy_alloc(yy_string_array_t, _yy_string_array_dealloc);
+    if (array == NULL) {
+        yy_log_error("yy_string_array_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_string_array_t));
+        return NULL;
+    }
+    if (!_yy_string_array_reserve(array, count, byte_count)) {
+        yy_release(array);
+        return NULL;
+    }
+    return array;
+}
+
+long yy_string_array_count(yy_string_array_t *array) {
+    return array->count;
+}
+
+const char * yy_string_array_get(yy_string_array_t *array, long index) {
+    if (!_yy_string_array_validate_index(array, index, __func__)) {
+        return NULL;
+    }
+    return array->bytes + array->entries[index].offset;
+}
+
+long yy_string_array_get_length(yy_string_array_t *array, long index) {
+    if (!_yy_string_array_validate_index(array, index, __func__)) {
+        return 0;
+    }
+    return array->entries[index].length;
+}
+
+bool yy_string_array_append(yy_string_array_t *array, const char *string) {
+    if (string == NULL) {
+        yy_log_error("yy_string_array_t(%p):%s() string cannot be null",
+                     array, __func__);
+        return false;
+    }
+    return yy_string_array_append_with_length(array, string, strlen(string));
+}
+
+bool yy_string_array_append_with_length(yy_string_array_t *array, const char *string, long length) {
+    yy_string_entry_t *entry;
+    
+    if (length < 0 || length > UINT32_MAX || (string == NULL && length > 0)) {
+        yy_log_error("yy_string_array_t(%p):%s() invalid string(%p) length(%ld)",
+                     array, __func__, string, length);
+        return false;
+    }
+    if (!_yy_string_array_reserve(array, array->count + 1, array->byte_count + length + 1)) {
+        return false;
+    }
+    entry = array->entries + array->count;
+    entry->prefix = _yy_string_array_prefix(string, length);
+    entry->offset = array->byte_count;
+    entry->length = (uint32_t)length;
+    entry->hash = _yy_string_array_hash(string, length);
+    if (length > 0) memcpy(array->bytes + array->byte_count, string, length);
+    array->bytes[array->byte_count + length] = '\0';
+    array->byte_count += length + 1;
+    array->count++;
+    return true;
+}
+
+bool yy_string_array_remove(yy_string_array_t *array, long index) {
+    if (!_yy_string_array_validate_index(array, index, __func__)) {
+        return false;
+    }
+    array->garbage += array->entries[index].length + 1;
+    memmove(array->entries + index,
+            array->entries + index + 1,
+            (array->count - index - 1) * sizeof(yy_string_entry_t));
+    array->count--;
+    if (array->count == 0) {
+        array->byte_count = 0;
+        array->garbage = 0;
+    } else if (array->garbage > YY_STRING_ARRAY_COMPACT_BYTES && array->garbage > array->byte_count / 2) {
+        yy_string_array_compact(array);
+    }
+    return true;
+}
+
+bool yy_string_array_clear(yy_string_array_t *array) {
+    free(array->entries);
+    free(array->bytes);
+    array->entries = NULL;
+    array->bytes = NULL;
+    array->count = 0;
+    array->capacity = 0;
+    array->byte_count = 0;
+    array->byte_capacity = 0;
+    array->garbage = 0;
+    YY_REGISTRY_SET_BYTES(array, yy_string_array_get_memory_size(array));
+    return true;
+}
+
+bool yy_string_array_contains(yy_string_array_t *array, const char *string) {
+    return yy_string_array_get_first_index(array, string) != YY_NOT_FOUND;
+}
+
+long yy_string_array_get_first_index(yy_string_array_t *array, const char *string) {
+    if (string == NULL) return YY_NOT_FOUND;
+    return yy_string_array_get_first_index_with_length(array, string, strlen(string));
+}
+
+long yy_string_array_get_first_index_with_length(yy_string_array_t *array, const char *string, long length) {
+    yy_string_entry_t *entry, *end;
+    uint32_t hash;
+    
+    if (length < 0 || length > UINT32_MAX || (string == NULL && length > 0)) return YY_NOT_FOUND;
+    hash = _yy_string_array_hash(string, length);
+    end = array->entries + array->count;
+    for (entry = array->entries; entry < end; entry++) {
+        if (entry->hash == hash && entry->length == length
+            && memcmp(array->bytes + entry->offset, string, length) == 0) {
+            return entry - array->entries;
+        }
+    }
+    return YY_NOT_FOUND;
+}
+
+static yy_order _yy_string_array_compare(const void *value1, const void *value2, void *context) {
+    const yy_string_entry_t *entry1 = value1, *entry2 = value2;
+    const char *bytes = context;
+    uint32_t length;
+    int result;
+    
+    if (entry1->prefix != entry2->prefix) {
+        return entry1->prefix < entry2->prefix ? YY_ORDER_ASC : YY_ORDER_DESC;
+    }
+    length = YY_MIN(entry1->length, entry2->length);
+    if (length > 8) {
+        result = memcmp(bytes + entry1->offset + 8, bytes + entry2->offset + 8, length - 8);
+        if (result != 0) return result < 0 ? YY_ORDER_ASC : YY_ORDER_DESC;
+    }
+    if (entry1->length == entry2->length) return YY_ORDER_EQUAL;
+    return entry1->length < entry2->length ? YY_ORDER_ASC : YY_ORDER_DESC;
+}
+
+bool yy_string_array_sort(yy_string_array_t *array) {
+    yy_string_entry_t *entries;
+    const void **order;
+    long i;
+    
+    if (array->count <= 1) return true;
+    order = malloc(array->count * sizeof(void *));
+    entries = malloc(array->capacity * sizeof(yy_string_entry_t));
+    if (order == NULL || entries == NULL) {
+        yy_log_error("yy_string_array_t(%p):%s() attempt to allocate %ld bytes failed",
+                     array, __func__, array->count * (sizeof(void *) + sizeof(yy_string_entry_t)));
+        free(order);
+        free(entries);
+        return false;
+    }
+    for (i = 0; i < array->count; i++) {
+        order[i] = array->entries + i;
+    }
+    yy_quick_sort(order, array->count, _yy_string_array_compare, array->bytes);
+    for (i = 0; i < array->count; i++) {
+        entries[i] = *(const yy_string_entry_t *)order[i];
+    }
+    free(order);
+    free(array->entries);
+    array->entries = entries;
+    return true;
+}
+
+bool yy_string_array_foreach(yy_string_array_t *array, yy_array_foreach_func func, void *context) {
+    long i;
+    
+    if (!func) return false;
+    for (i = 0; i < array->count; i++) {
+        func(i, array->bytes + array->entries[i].offset, context);
+    }
+    return true;
+}
+
+bool yy_string_array_compact(yy_string_array_t *array) {
+    yy_string_entry_t *entry;
+    char *bytes;
+    long i, capacity, byte_count;
+    
+    if (array->garbage == 0 && array->capacity <= YY_MAX(array->count * 2, YY_STRING_ARRAY_MIN_COUNT)) return true;
+    capacity = YY_STRING_ARRAY_MIN_BYTES;
+    while (capacity < array->byte_count - array->garbage) capacity <<= 1;
+    bytes = malloc(capacity);
+    if (bytes == NULL) {
+        yy_log_error("yy_string_array_t(%p):%s() attempt to allocate %ld bytes failed",
+                     array, __func__, capacity);
+        return false;
+    }
+    byte_count = 0;
+    for (i = 0; i < array->count; i++) {
+        entry = array->entries + i;
+        memcpy(bytes + byte_count, array->bytes + entry->offset, entry->length + 1);
+        entry->offset = byte_count;
+        byte_count += entry->length + 1;
+    }
+    free(array->bytes);
+    array->bytes = bytes;
+    array->byte_count = byte_count;
+    array->byte_capacity = capacity;
+    array->garbage = 0;
+    
+    /* shrink the table too, a failure here is harmless */
+    capacity = YY_STRING_ARRAY_MIN_COUNT;
+    while (capacity < array->count) capacity <<= 1;
+    if (capacity < array->capacity) {
+        entry = realloc(array->entries, capacity * sizeof(yy_string_entry_t));
+        if (entry) {
+            array->entries = entry;
+            array->capacity = capacity;
+        }
+    }
+    YY_REGISTRY_SET_BYTES(array, yy_string_array_get_memory_size(array));
+    return true;
+}
+
+long yy_string_array_get_memory_size(yy_string_array_t *array) {
+    return sizeof(yy_string_array_t)
+        + array->capacity * sizeof(yy_string_entry_t)
+        + array->byte_capacity;
+}
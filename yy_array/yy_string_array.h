@@ -0,0 +1,67 @@
+//
+//  yy_string_array.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_string_array_h
+#define YYMidiBase_yy_string_array_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yy_base.h"
+#include "yy_array.h"
+
+/**
+ YY String Array  (strings packed in one buffer)
+ 
+ Unlike yy_array_create_for_string(), the strings are not allocated one by
+ one: their bytes are appended to a single growable buffer (NUL-terminated)
+ and a table keeps the offset, length, hash and first 8 bytes of each string.
+ Lookups compare hash and length before the bytes, sorting compares the
+ cached prefixes first.
+ 
+ The strings returned by yy_string_array_get() are valid until the array is
+ modified. Removed strings leave holes in the buffer, they are reclaimed by
+ yy_string_array_compact() (called automatically when half of it is unused).
+ 
+ Example:
+ yy_string_array_t *array = yy_string_array_create();
+ yy_string_array_append(array, "hello");
+ yy_string_array_append(array, "world");
+ yy_string_array_sort(array);
+ yy_release(array);
+ */
+typedef struct _yy_string_array yy_string_array_t;
+
+yy_string_array_t * yy_string_array_create();
+yy_string_array_t * yy_string_array_create_with_capacity(long count, long byte_count);
+
+long yy_string_array_count(yy_string_array_t *array);
+const char * yy_string_array_get(yy_string_array_t *array, long index);
+long yy_string_array_get_length(yy_string_array_t *array, long index);
+bool yy_string_array_append(yy_string_array_t *array, const char *string);
+/// Append `length` bytes (may contain NUL).
+bool yy_string_array_append_with_length(yy_string_array_t *array, const char *string, long length);
+bool yy_string_array_remove(yy_string_array_t *array, long index);
+bool yy_string_array_clear(yy_string_array_t *array);
+bool yy_string_array_contains(yy_string_array_t *array, const char *string);
+long yy_string_array_get_first_index(yy_string_array_t *array, const char *string);
+long yy_string_array_get_first_index_with_length(yy_string_array_t *array, const char *string, long length);
+/// Sort the strings in byte order (strcmp order), shorter first on equal prefix.
+bool yy_string_array_sort(yy_string_array_t *array);
+/// Apply func to every string (values are const char *).
+bool yy_string_array_foreach(yy_string_array_t *array, yy_array_foreach_func func, void *context);
+
+/// Rewrite the buffer without the bytes of removed strings.
+bool yy_string_array_compact(yy_string_array_t *array);
+
+/// Bytes used by the array (table and buffer).
+long yy_string_array_get_memory_size(yy_string_array_t *array);
+
+#endif
@@ -0,0 +1,345 @@
+//
+//  yy_timer_wheel.c
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#include "yy_timer_wheel.h"
+#include "yy_base_private.h"
+#include "yy_log.h"
+
+#include <string.h>
+#include <limits.h>
+
+#define YY_TIMER_WHEEL_LEVELS 6
+#define YY_TIMER_WHEEL_SLOT_BITS 6
+#define YY_TIMER_WHEEL_SLOTS (1 << YY_TIMER_WHEEL_SLOT_BITS)
+#define YY_TIMER_WHEEL_SLOT_MASK (YY_TIMER_WHEEL_SLOTS - 1)
+
+/// Lists: the slots of every level, then the overflow list and the list being fired.
+#define YY_TIMER_WHEEL_OVERFLOW_LIST (YY_TIMER_WHEEL_LEVELS * YY_TIMER_WHEEL_SLOTS)
+#define YY_TIMER_WHEEL_FIRING_LIST (YY_TIMER_WHEEL_OVERFLOW_LIST + 1)
+#define YY_TIMER_WHEEL_LIST_COUNT (YY_TIMER_WHEEL_FIRING_LIST + 1)
+
+/// The list of a free node.
+#define YY_TIMER_WHEEL_FREE (-1)
+
+#define YY_TIMER_WHEEL_MIN_CAPACITY 64
+
+typedef struct _yy_timer_wheel_node {
+    uint64_t time;
+    const void *value;
+    long prev;              ///< circular list, the prev of the head is the tail
+    long next;              ///< next node (or next free node)
+    long list;              ///< list index, or YY_TIMER_WHEEL_FREE
+} yy_timer_wheel_node_t;
+
+struct _yy_timer_wheel {
+    uint64_t now;           ///< next tick to fire, cascaded
+    long count;
+    long capacity;
+    yy_timer_wheel_node_t *nodes;
+    long free_node;
+    long heads[YY_TIMER_WHEEL_LIST_COUNT];              ///< first node of each list, or YY_NOT_FOUND
+    uint64_t bitmaps[YY_TIMER_WHEEL_LEVELS];            ///< non-empty slots of each level
+    bool firing;            ///< inside yy_timer_wheel_advance(), the callbacks cannot advance or clear
+};
+
+yy_inline void _yy_timer_wheel_link(yy_timer_wheel_t *wheel, long list, long index) {
+    yy_timer_wheel_node_t *node, *head;
+    
+    node = wheel->nodes + index;
+    node->list = list;
+    if (wheel->heads[list] == YY_NOT_FOUND) {
+        node->prev = index;
+        node->next = YY_NOT_FOUND;
+        wheel->heads[list] = index;
+    } else {
+        /* append after the tail, the timers of a slot stay in schedule order */
+        head = wheel->nodes + wheel->heads[list];
+        node->prev = head->prev;
+        node->next = YY_NOT_FOUND;
+        wheel->nodes[head->prev].next = index;
+        head->prev = index;
+    }
+    if (list < YY_TIMER_WHEEL_OVERFLOW_LIST) {
+        wheel->bitmaps[list >> YY_TIMER_WHEEL_SLOT_BITS] |= 1ULL << (list & YY_TIMER_WHEEL_SLOT_MASK);
+    }
+}
+
+yy_inline void _yy_timer_wheel_unlink(yy_timer_wheel_t *wheel, long index) {
+    yy_timer_wheel_node_t *node;
+    long list, head;
+    
+    node = wheel->nodes + index;
+    list = node->list;
+    head = wheel->heads[list];
+    if (index == head) {
+        wheel->heads[list] = node->next;
+        if (node->next != YY_NOT_FOUND) wheel->nodes[node->next].prev = node->prev;
+    } else {
+        wheel->nodes[node->prev].next = node->next;
+        if (node->next != YY_NOT_FOUND) wheel->nodes[node->next].prev = node->prev;
+        else wheel->nodes[head].prev = node->prev;
+    }
+    if (wheel->heads[list] == YY_NOT_FOUND && list < YY_TIMER_WHEEL_OVERFLOW_LIST) {
+        wheel->bitmaps[list >> YY_TIMER_WHEEL_SLOT_BITS] &= ~(1ULL << (list & YY_TIMER_WHEEL_SLOT_MASK));
+    }
+}
+
+/**
+ * Put a node in the lowest level where its time shares the upper bits with
+ * the wheel time. On levels > 0 the slot is then always after the current one.
+ */
+static void _yy_timer_wheel_place(yy_timer_wheel_t *wheel, long index) {
+    uint64_t time;
+    long level;
+    
+    time = wheel->nodes[index].time;
+    if (time < wheel->now) time = wheel->now;
+    for (level = 0; level < YY_TIMER_WHEEL_LEVELS; level++) {
+        if ((time >> (YY_TIMER_WHEEL_SLOT_BITS * (level + 1))) == (wheel->now >> (YY_TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+            _yy_timer_wheel_link(wheel, level * YY_TIMER_WHEEL_SLOTS
+                                 + ((time >> (YY_TIMER_WHEEL_SLOT_BITS * level)) & YY_TIMER_WHEEL_SLOT_MASK),
+                                 index);
+            return;
+        }
+    }
+    _yy_timer_wheel_link(wheel, YY_TIMER_WHEEL_OVERFLOW_LIST, index);
+}
+
+/// Place again every node of a list (relative to the current wheel time), a node may go back to the same list.
+static void _yy_timer_wheel_cascade_list(yy_timer_wheel_t *wheel, long list) {
+    long index, next;
+    
+    index = wheel->heads[list];
+    wheel->heads[list] = YY_NOT_FOUND;
+    if (list < YY_TIMER_WHEEL_OVERFLOW_LIST) {
+        wheel->bitmaps[list >> YY_TIMER_WHEEL_SLOT_BITS] &= ~(1ULL << (list & YY_TIMER_WHEEL_SLOT_MASK));
+    }
+    while (index != YY_NOT_FOUND) {
+        next = wheel->nodes[index].next;
+        _yy_timer_wheel_place(wheel, index);
+        index = next;
+    }
+}
+
+/**
+ * Move the wheel time, and move down the timers of the upper slots that
+ * start at this time (highest level first).
+ */
+static void _yy_timer_wheel_set_now(yy_timer_wheel_t *wheel, uint64_t now) {
+    long level;
+    
+    wheel->now = now;
+    if (now & YY_TIMER_WHEEL_SLOT_MASK) return;
+    if ((now & ((1ULL << (YY_TIMER_WHEEL_SLOT_BITS * YY_TIMER_WHEEL_LEVELS)) - 1)) == 0) {
+        _yy_timer_wheel_cascade_list(wheel, YY_TIMER_WHEEL_OVERFLOW_LIST);
+    }
+    for (level = YY_TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+        if (now & ((1ULL << (YY_TIMER_WHEEL_SLOT_BITS * level)) - 1)) continue;
+        _yy_timer_wheel_cascade_list(wheel, level * YY_TIMER_WHEEL_SLOTS
+                                     + ((now >> (YY_TIMER_WHEEL_SLOT_BITS * level)) & YY_TIMER_WHEEL_SLOT_MASK));
+    }
+}
+
+/**
+ * The next time something happens: the start of the first non-empty slot
+ * (level 0 includes the current slot), or the turn of the whole wheel of
+ * the earliest timer if only the overflow list has timers.
+ */
+static bool _yy_timer_wheel_next_event(yy_timer_wheel_t *wheel, uint64_t *time) {
+    uint64_t bits, base, min;
+    long level, shift, slot, index;
+    
+    for (level = 0; level < YY_TIMER_WHEEL_LEVELS; level++) {
+        shift = YY_TIMER_WHEEL_SLOT_BITS * level;
+        slot = (wheel->now >> shift) & YY_TIMER_WHEEL_SLOT_MASK;
+        bits = wheel->bitmaps[level] & (~0ULL << slot);
+        if (level > 0) bits &= ~(1ULL << slot);
+        if (bits == 0) continue;
+        base = (wheel->now >> (shift + YY_TIMER_WHEEL_SLOT_BITS)) << (shift + YY_TIMER_WHEEL_SLOT_BITS);
+        *time = base + ((uint64_t)__builtin_ctzll(bits) << shift);
+        return true;
+    }
+    if (wheel->heads[YY_TIMER_WHEEL_OVERFLOW_LIST] != YY_NOT_FOUND) {
+        /* jump to the turn of the earliest overflow timer, not just the next turn */
+        min = UINT64_MAX;
+        for (index = wheel->heads[YY_TIMER_WHEEL_OVERFLOW_LIST]; index != YY_NOT_FOUND; index = wheel->nodes[index].next) {
+            min = YY_MIN(min, wheel->nodes[index].time);
+        }
+        shift = YY_TIMER_WHEEL_SLOT_BITS * YY_TIMER_WHEEL_LEVELS;
+        *time = (min >> shift) << shift;
+        return true;
+    }
+    return false;
+}
+
+static bool _yy_timer_wheel_reserve(yy_timer_wheel_t *wheel, long count) {
+    yy_timer_wheel_node_t *nodes;
+    long capacity, i;
+    
+    if (count <= wheel->capacity) return true;
+    capacity = YY_MAX(wheel->capacity * 2, YY_TIMER_WHEEL_MIN_CAPACITY);
+    if (capacity > LONG_MAX / (long)sizeof(yy_timer_wheel_node_t)) {
+        yy_log_error("yy_timer_wheel_t(%p):%s() capacity(%ld) overflow", wheel, __func__, capacity);
+        return false;
+    }
+    nodes = realloc(wheel->nodes, capacity * sizeof(yy_timer_wheel_node_t));
+    if (nodes == NULL) {
+        yy_log_error("yy_timer_wheel_t(%p):%s() attempt to allocate %ld bytes failed",
+                     wheel, __func__, capacity * sizeof(yy_timer_wheel_node_t));
+        return false;
+    }
+    for (i = capacity - 1; i >= wheel->capacity; i--) {
+        nodes[i].list = YY_TIMER_WHEEL_FREE;
+        nodes[i].next = wheel->free_node;
+        wheel->free_node = i;
+    }
+    wheel->nodes = nodes;
+    wheel->capacity = capacity;
+    YY_REGISTRY_SET_BYTES(wheel, sizeof(yy_timer_wheel_t) + capacity * sizeof(yy_timer_wheel_node_t));
+    return true;
+}
+
+yy_inline void _yy_timer_wheel_free_node(yy_timer_wheel_t *wheel, long index) {
+    wheel->nodes[index].list = YY_TIMER_WHEEL_FREE;
+    wheel->nodes[index].value = NULL;
+    wheel->nodes[index].next = wheel->free_node;
+    wheel->free_node = index;
+    wheel->count--;
+}
+
+static void _yy_timer_wheel_dealloc(yy_timer_wheel_t *wheel) {
+    free(wheel->nodes);
+    yy_dealloc(wheel);
+}
+
+yy_timer_wheel_t *yy_timer_wheel_create(uint64_t now) {
+    yy_timer_wheel_t *wheel;
+    long i;
+    
+    wheel = yy_alloc(yy_timer_wheel_t, _yy_timer_wheel_dealloc);
+    if (wheel == NULL) {
+        yy_log_error("yy_timer_wheel_t:%s() attempt to allocate %ld bytes failed",
+                     __func__, sizeof(yy_timer_wheel_t));
+        return NULL;
+    }
+    wheel->now = now;
+    wheel->free_node = YY_NOT_FOUND;
+    for (i = 0; i < YY_TIMER_WHEEL_LIST_COUNT; i++) wheel->heads[i] = YY_NOT_FOUND;
+    return wheel;
+}
+
+long yy_timer_wheel_count(yy_timer_wheel_t *wheel) {
+    return wheel->count;
+}
+
+uint64_t yy_timer_wheel_get_time(yy_timer_wheel_t *wheel) {
+    return wheel->now;
+}
+
+long yy_timer_wheel_schedule(yy_timer_wheel_t *wheel, uint64_t time, const void *value) {
+    long index;
+    
+    if (!_yy_timer_wheel_reserve(wheel, wheel->count + 1)) return YY_NOT_FOUND;
+    index = wheel->free_node;
+    wheel->free_node = wheel->nodes[index].next;
+    wheel->nodes[index].time = time;
+    wheel->nodes[index].value = value;
+    wheel->count++;
+    _yy_timer_wheel_place(wheel, index);
+    return index;
+}
+
+bool yy_timer_wheel_cancel(yy_timer_wheel_t *wheel, long handle, const void **value) {
+    if (handle < 0 || handle >= wheel->capacity || wheel->nodes[handle].list == YY_TIMER_WHEEL_FREE) {
+        yy_log_error("yy_timer_wheel_t(%p):%s() invalid handle(%ld)", wheel, __func__, handle);
+        return false;
+    }
+    if (value) *value = wheel->nodes[handle].value;
+    _yy_timer_wheel_unlink(wheel, handle);
+    _yy_timer_wheel_free_node(wheel, handle);
+    return true;
+}
+
+long yy_timer_wheel_advance(yy_timer_wheel_t *wheel, uint64_t now, yy_timer_wheel_fire_func func, void *context) {
+    yy_timer_wheel_node_t *node;
+    uint64_t time, tick;
+    const void *value;
+    long fired, index, list;
+    
+    if (func == NULL) {
+        yy_log_error("yy_timer_wheel_t(%p):%s() func cannot be NULL", wheel, __func__);
+        return 0;
+    }
+    if (wheel->firing) {
+        yy_log_error("yy_timer_wheel_t(%p):%s() cannot be called from the fire callback", wheel, __func__);
+        return 0;
+    }
+    fired = 0;
+    wheel->firing = true;
+    while (wheel->now <= now) {
+        if (!_yy_timer_wheel_next_event(wheel, &time) || time > now) {
+            _yy_timer_wheel_set_now(wheel, now + 1);
+            break;
+        }
+        if (time > wheel->now) {
+            /* skip the empty slots, cascading on arrival */
+            _yy_timer_wheel_set_now(wheel, time);
+            continue;
+        }
+        
+        /* move the current slot to the firing list, so the callbacks can schedule and cancel */
+        tick = wheel->now;
+        list = tick & YY_TIMER_WHEEL_SLOT_MASK;
+        wheel->heads[YY_TIMER_WHEEL_FIRING_LIST] = wheel->heads[list];
+        wheel->heads[list] = YY_NOT_FOUND;
+        wheel->bitmaps[0] &= ~(1ULL << list);
+        for (index = wheel->heads[YY_TIMER_WHEEL_FIRING_LIST]; index != YY_NOT_FOUND; index = wheel->nodes[index].next) {
+            wheel->nodes[index].list = YY_TIMER_WHEEL_FIRING_LIST;
+        }
+        _yy_timer_wheel_set_now(wheel, tick + 1);
+        
+        while ((index = wheel->heads[YY_TIMER_WHEEL_FIRING_LIST]) != YY_NOT_FOUND) {
+            node = wheel->nodes + index;
+            time = node->time;
+            value = node->value;
+            _yy_timer_wheel_unlink(wheel, index);
+            _yy_timer_wheel_free_node(wheel, index);
+            fired++;
+            func(index, time, value, context);
+        }
+    }
+    wheel->firing = false;
+    return fired;
+}
+
+bool yy_timer_wheel_get_next_time(yy_timer_wheel_t *wheel, uint64_t *time) {
+    uint64_t next;
+    
+    if (!_yy_timer_wheel_next_event(wheel, &next)) return false;
+    if (time) *time = next;
+    return true;
+}
+
+bool yy_timer_wheel_clear(yy_timer_wheel_t *wheel) {
+    long i;
+    
+    if (wheel->firing) {
+        yy_log_error("yy_timer_wheel_t(%p):%s() cannot be called from the fire callback", wheel, __func__);
+        return false;
+    }
+    for (i = 0; i < YY_TIMER_WHEEL_LIST_COUNT; i++) wheel->heads[i] = YY_NOT_FOUND;
+    memset(wheel->bitmaps, 0, sizeof(wheel->bitmaps));
+    wheel->free_node = YY_NOT_FOUND;
+    for (i = wheel->capacity - 1; i >= 0; i--) {
+        wheel->nodes[i].list = YY_TIMER_WHEEL_FREE;
+        wheel->nodes[i].next = wheel->free_node;
+        wheel->free_node = i;
+    }
+    wheel->count = 0;
+    return true;
+}
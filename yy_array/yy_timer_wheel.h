@@ -0,0 +1,80 @@
+//
+//  yy_timer_wheel.h
+//  YYMidiBase
+//
+//  Created by agent on 26-10-19.
+//  Copyright (c) 2026 agent. Released under the MIT License (see LICENSE).
+//
+
+#ifndef YYMidiBase_yy_timer_wheel_h
+#define YYMidiBase_yy_timer_wheel_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "yy_base.h"
+
+/// Prototype of a callback function invoked for every timer fired by yy_timer_wheel_advance().
+typedef void (*yy_timer_wheel_fire_func)(long handle, uint64_t time, const void *value, void *context);
+
+/**
+ YY Timer Wheel  (hierarchical timing wheel)
+ 
+ Schedules values at integer times (ticks, in any unit), to fire them in time
+ order. 6 levels of 64-slot rings cover 2^36 ticks ahead (level l slots are
+ 64^l ticks wide), farther timers wait in an overflow list. A timer is moved
+ down one level at a time when the wheel time reaches its slot, so schedule
+ and cancel are O(1) and every timer is moved at most 6 times.
+ 
+ advance() jumps over empty slots with a per-level bitmap, so advancing
+ by a large amount is cheap. Timers at the same time fire in schedule order.
+ 
+ Values are not retained. Handles stay valid until the timer fires or is
+ cancelled, they are reused afterwards.
+ 
+ Example:
+ yy_timer_wheel_t *wheel = yy_timer_wheel_create(0);
+ yy_timer_wheel_schedule(wheel, 480, note_off);
+ ...
+ yy_timer_wheel_advance(wheel, now, play_event, player);
+ yy_release(wheel);
+ */
+typedef struct _yy_timer_wheel yy_timer_wheel_t;
+
+/// Create an empty wheel, its time starts at `now`.
+yy_timer_wheel_t *yy_timer_wheel_create(uint64_t now);
+
+long yy_timer_wheel_count(yy_timer_wheel_t *wheel);
+/// The time of the next tick to fire (the last time advanced to + 1).
+uint64_t yy_timer_wheel_get_time(yy_timer_wheel_t *wheel);
+
+/**
+ Schedule a value at `time`. A time already passed fires at the next advance.
+ @return the handle of the timer, or YY_NOT_FOUND on failure.
+ */
+long yy_timer_wheel_schedule(yy_timer_wheel_t *wheel, uint64_t time, const void *value);
+/// Cancel a pending timer, value receives its value (can be NULL).
+bool yy_timer_wheel_cancel(yy_timer_wheel_t *wheel, long handle, const void **value);
+
+/**
+ Fire every timer whose time is <= now, in time order, and move the wheel
+ time to now + 1. The callback may schedule and cancel timers (not advance
+ or clear): a new timer fires in the same call if its time is after the
+ firing one and <= now, an earlier time is moved to the next tick.
+ @return the number of timers fired.
+ */
+long yy_timer_wheel_advance(yy_timer_wheel_t *wheel, uint64_t now, yy_timer_wheel_fire_func func, void *context);
+
+/**
+ Get the time of the next timer to fire, without firing anything.
+ The result may be earlier than the actual time (a slot boundary) when the
+ next timer is still in an upper level.
+ @return false if there is no timer.
+ */
+bool yy_timer_wheel_get_next_time(yy_timer_wheel_t *wheel, uint64_t *time);
+
+bool yy_timer_wheel_clear(yy_timer_wheel_t *wheel);
+
+#endif